@@ -7,6 +7,9 @@
   - 800 KHz WS2812, WS2812B, WS2813 and 400kHz bitstream and WS2811
   - 800 KHz bitstream SK6812RGBW (NeoPixel RGBW pixel strips)
     (use 'SK6812RGBW' as PIXEL_TYPE)
+  - 800 KHz bitstream WS2816 and UCS8903 (16 bits per color)
+  - 800 KHz bitstream WS2805 (RGBCW, RGB + cool white + warm white)
+  - APA102 and SK9822 clocked pixels on hardware SPI
 
   Also supports:
   - Radio Shack Tri-Color Strip with TM1803 controller 400kHz bitstream.
@@ -53,6 +56,14 @@
 
 #include "neopixel.h"
 
+// Pixel type of the strip: a constant with NEO_ONLY_TYPE, so that the
+// type table lookups fold away and unused code is left out.
+#ifdef NEO_ONLY_TYPE
+#define NEO_TYPE ((uint8_t)(NEO_ONLY_TYPE))
+#else
+#define NEO_TYPE type
+#endif
+
 #if PLATFORM_ID == 0 // Core (0)
   #define pinLO(_pin) (PIN_MAP[_pin].gpio_peripheral->BRR = PIN_MAP[_pin].gpio_pin)
   #define pinHI(_pin) (PIN_MAP[_pin].gpio_peripheral->BSRR = PIN_MAP[_pin].gpio_pin)
@@ -73,40 +84,248 @@
 #else
   NRF5x_Pin_Info* PIN_MAP2 = hal_pin_map();
 #endif // SYSTEM_VERSION < SYSTEM_VERSION_ALPHA(5,0,0,2)
-  #define pinLO(_pin) (nrf_gpio_pin_clear(NRF_GPIO_PIN_MAP(PIN_MAP2[_pin].gpio_port, PIN_MAP2[_pin].gpio_pin)))
-  #define pinHI(_pin) (nrf_gpio_pin_set(NRF_GPIO_PIN_MAP(PIN_MAP2[_pin].gpio_port, PIN_MAP2[_pin].gpio_pin)))
+#if defined(NEO_NO_PWM) && defined(NEO_NO_DWT_FALLBACK)
+  #error "NEO_NO_PWM and NEO_NO_DWT_FALLBACK leave no way to drive the strip"
+#endif
+#ifndef NEO_NO_PWM
+  static void encodePwm(uint8_t* pattern, const uint8_t* in, uint32_t bytes);
+  static void setPwmPattern(uint16_t t0h, uint16_t t1h);
+#endif
 #elif (PLATFORM_ID == 32) // HAL_PLATFORM_RTL872X
   // nothing extra needed for P2
 #else
   #error "*** PLATFORM_ID not supported by this library. PLATFORM should be Particle Core, Photon, Electron, Argon, Boron, Xenon, RedBear Duo, B SoM, B5 SoM, E SoM X, Tracker or P2 ***"
 #endif
-// fast pin access
+#if (PLATFORM_ID == 0) || (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88)
+// fast pin access for the hand-tuned STM32 loops
 #define pinSet(_pin, _hilo) (_hilo ? pinHI(_pin) : pinLO(_pin))
+#endif
 
 #if (PLATFORM_ID == 32)
-Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, SPIClass& spi, uint8_t t) :
-  begun(false), type(t), brightness(0), pixels(NULL), endTime(0)
+// Expand pixel bytes into the SPI bitstream, 3 SPI bits per data bit
+// (0b110 = 1, 0b100 = 0), so each pixel byte becomes 3 SPI bytes.
+static void encodeSpi(uint8_t* out, const uint8_t* in, uint32_t bytes) {
+  constexpr uint8_t PIX_HI = 0b110;
+  constexpr uint8_t PIX_LO = 0b100;
+
+  for (uint32_t i = 0; i < bytes; i++) {
+    uint8_t v = in[i];
+    *out++ = ((0x80 & v)?(PIX_HI << 5):(PIX_LO << 5)) + ((0x40 & v)?(PIX_HI << 2):(PIX_LO << 2)) + ((0x20 & v)?(0b11):(0b10));
+    *out++ = 0 /* bit 7 always 0 */ + ((0x10 & v)?(PIX_HI << 4):(PIX_LO << 4)) + ((0x08 & v)?(PIX_HI << 1):(PIX_LO << 1)) + 1 /* bit 0 always 1 */;
+    *out++ = ((0x04 & v)?(0b10 << 6):(0b00 << 6)) + ((0x02 & v)?(PIX_HI << 3):(PIX_LO << 3)) + ((0x01 & v)?(PIX_HI):(PIX_LO));
+  }
+}
+
+// Set from the SPI DMA completion callback when sending long strips in chunks
+static volatile bool spiChunkDone = true;
+static void spiChunkComplete(void) {
+  spiChunkDone = true;
+}
+
+// Send 'bytes' of zeros (a reset period) by blocking transfers
+static void spiSendZeros(SPIClass* spi, uint32_t bytes) {
+  static uint8_t zeros[128]; // in RAM for DMA
+  for (uint32_t len; bytes; bytes -= len) {
+    len = (bytes > sizeof(zeros)) ? sizeof(zeros) : bytes;
+    spi->transfer(zeros, nullptr, len, nullptr);
+  }
+}
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint32_t n, SPIClass& spi, uint8_t t) :
+  Adafruit_NeoPixel(n, spi, t, NULL, 0, NULL, 0)
+{
+}
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint32_t n, SPIClass& spi, uint8_t t,
+    uint8_t* buf, uint32_t bufBytes, uint8_t* enc, uint32_t encBytes) :
+  begun(false), ownPixels(buf == NULL), constPixels(false), fixedBuffers(buf != NULL || enc != NULL),
+  customTiming(false), skipUnchanged(false),
+  numLEDs(0), numBytes(0), maxBytes(bufBytes),
+  type(t), brightness(0), paletteBits(0), pixels(buf), palette(NULL),
+  ditherMode(NEO_DITHER_DIFFUSION), ditherFrame(0), ditherErr(NULL), pixels16(NULL),
+  encodeBuf(enc), encodeBytes(encBytes),
+  endTime(0), blackoutUs(0), driftUs(0), whiteColor(0),
+  dirtyFirst(0), dirtyEnd(UINT32_MAX), skippedFrames(0), whitePos(), whiteMul(), profile(), spi_(&spi),
+  cachePool(NULL), cacheBytes(0), cacheSlotBytes(0), cacheSlots(0), cacheClock(0),
+  cacheHits(0), cacheMisses(0)
 {
   updateLength(n);
-  spi_ = &spi;
 }
 #else
-Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, uint8_t p, uint8_t t) :
-  begun(false), type(t), brightness(0), pixels(NULL), endTime(0)
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint32_t n, uint8_t p, uint8_t t) :
+  Adafruit_NeoPixel(n, p, t, NULL, 0, NULL, 0)
+{
+}
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint32_t n, uint8_t p, uint8_t t,
+    uint8_t* buf, uint32_t bufBytes, uint8_t* enc, uint32_t encBytes) :
+  begun(false), ownPixels(buf == NULL), constPixels(false), fixedBuffers(buf != NULL || enc != NULL),
+  customTiming(false), skipUnchanged(false),
+  numLEDs(0), numBytes(0), maxBytes(bufBytes),
+  type(t), brightness(0), paletteBits(0), pixels(buf), palette(NULL),
+  ditherMode(NEO_DITHER_DIFFUSION), ditherFrame(0), ditherErr(NULL), pixels16(NULL),
+  encodeBuf(enc), encodeBytes(encBytes),
+  endTime(0), blackoutUs(0), driftUs(0), whiteColor(0),
+  dirtyFirst(0), dirtyEnd(UINT32_MAX), skippedFrames(0), whitePos(), whiteMul(), profile(), spi_(NULL)
 {
+#if HAL_PLATFORM_NRF52840
+  pwm = NULL;
+  pwmT0H = pwmT1H = 0;
+  retryMax = NEO_RETRY_UNLIMITED;
+  retryBudgetUs = 0;
+  lastRetries = 0;
+  giveUps = 0;
+  cachePool = NULL;
+  cacheBytes = cacheSlotBytes = cacheSlots = cacheClock = 0;
+  cacheHits = cacheMisses = 0;
+#endif
   updateLength(n);
   setPin(p);
 }
 
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint32_t n, SPIClass& spi, uint8_t t) :
+  Adafruit_NeoPixel(n, spi, t, NULL, 0, NULL, 0)
+{
+}
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint32_t n, SPIClass& spi, uint8_t t,
+    uint8_t* buf, uint32_t bufBytes, uint8_t* enc, uint32_t encBytes) :
+  Adafruit_NeoPixel(n, (uint8_t)PIN_INVALID, t, buf, bufBytes, enc, encBytes)
+{
+  spi_ = &spi;
+}
+
 #endif // #if (PLATFORM_ID == 32)
 
 Adafruit_NeoPixel::~Adafruit_NeoPixel() {
-  if (pixels) free(pixels);
+  release();
+}
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(Adafruit_NeoPixel&& other) noexcept {
+  moveFrom(other);
+}
+
+Adafruit_NeoPixel& Adafruit_NeoPixel::operator=(Adafruit_NeoPixel&& other) noexcept {
+  if (this != &other) {
+    release();
+    moveFrom(other);
+  }
+  return *this;
+}
+
+// Free the pixel buffer and give up the output pin / peripheral
+void Adafruit_NeoPixel::release(void) {
+  if (pixels && ownPixels) free(pixels);
+  if (palette) free(palette);
+  if (pixels16) free(pixels16);
+  if (ditherErr) free(ditherErr);
+  pixels = NULL;
+  palette = NULL;
+  pixels16 = NULL;
+  ditherErr = NULL;
+#if (PLATFORM_ID == 32) || HAL_PLATFORM_NRF52840
+  if (cachePool) free(cachePool);
+  cachePool = NULL;
+  cacheBytes = cacheSlots = 0;
+#endif
 #if (PLATFORM_ID == 32)
-  spi_->end();
+  if (spi_) spi_->end();
 #else
-  if (begun) pinMode(pin, INPUT);
+  if (spi_) {
+    if (begun) spi_->end();
+  } else {
+#if HAL_PLATFORM_NRF52840
+    releasePwm();
+#endif
+    if (begun) pinMode(pin, INPUT);
+  }
 #endif
+  begun = false;
+}
+
+// Take over the buffers, pin/SPI and state of 'other' without copying the
+// pixel data, and leave 'other' as an empty strip that owns nothing.  The
+// buffers of a StaticNeoPixel can't be taken over: 'other' keeps them and
+// this strip is left empty instead.
+void Adafruit_NeoPixel::moveFrom(Adafruit_NeoPixel& other) {
+  begun       = other.begun;
+  ownPixels   = other.ownPixels;
+  constPixels = other.constPixels;
+  fixedBuffers = other.fixedBuffers;
+  customTiming = other.customTiming;
+  skipUnchanged = other.skipUnchanged;
+  numLEDs     = other.numLEDs;
+  numBytes    = other.numBytes;
+  maxBytes    = other.maxBytes;
+  type        = other.type;
+  pin         = other.pin;
+  brightness  = other.brightness;
+  paletteBits = other.paletteBits;
+  pixels      = other.pixels;
+  palette     = other.palette;
+  ditherMode  = other.ditherMode;
+  ditherFrame = other.ditherFrame;
+  ditherErr   = other.ditherErr;
+  pixels16    = other.pixels16;
+  encodeBuf   = other.encodeBuf;
+  encodeBytes = other.encodeBytes;
+  endTime     = other.endTime;
+  blackoutUs  = other.blackoutUs;
+  driftUs     = other.driftUs;
+  whiteColor  = other.whiteColor;
+  memcpy(whitePos, other.whitePos, sizeof(whitePos));
+  memcpy(whiteMul, other.whiteMul, sizeof(whiteMul));
+  dirtyFirst  = other.dirtyFirst;
+  dirtyEnd    = other.dirtyEnd;
+  skippedFrames = other.skippedFrames;
+  profile     = other.profile;
+  spi_        = other.spi_;
+#if HAL_PLATFORM_NRF52840
+  pwm           = other.pwm;
+  pwmT0H        = other.pwmT0H;
+  pwmT1H        = other.pwmT1H;
+  retryMax      = other.retryMax;
+  lastRetries   = other.lastRetries;
+  retryBudgetUs = other.retryBudgetUs;
+  giveUps       = other.giveUps;
+#endif
+#if (PLATFORM_ID == 32) || HAL_PLATFORM_NRF52840
+  cachePool      = other.cachePool;
+  cacheBytes     = other.cacheBytes;
+  cacheSlotBytes = other.cacheSlotBytes;
+  cacheSlots     = other.cacheSlots;
+  cacheClock     = other.cacheClock;
+  cacheHits      = other.cacheHits;
+  cacheMisses    = other.cacheMisses;
+#endif
+
+  if (fixedBuffers) disown();
+  else other.disown();
+}
+
+// Forget the buffers and pin/SPI without releasing them, leaving an empty
+// strip that owns nothing (after they were handed over in moveFrom()).
+void Adafruit_NeoPixel::disown(void) {
+  spi_         = NULL;
+#if HAL_PLATFORM_NRF52840
+  pwm          = NULL;
+#endif
+#if (PLATFORM_ID == 32) || HAL_PLATFORM_NRF52840
+  cachePool    = NULL;
+  cacheBytes   = cacheSlots = 0;
+#endif
+  begun        = false;
+  ownPixels    = true;
+  constPixels  = false;
+  fixedBuffers = false;
+  pixels       = NULL;
+  palette      = NULL;
+  ditherErr    = NULL;
+  pixels16     = NULL;
+  paletteBits  = 0;
+  numLEDs      = numBytes = maxBytes = 0;
+  encodeBuf    = NULL;
+  encodeBytes  = 0;
 }
 
 uint8_t Adafruit_NeoPixel::getPin() const {
@@ -114,25 +333,98 @@ uint8_t Adafruit_NeoPixel::getPin() const {
 }
 
 uint8_t Adafruit_NeoPixel::getType() const {
-    return type;
+    return NEO_TYPE;
 }
 
-void Adafruit_NeoPixel::updateLength(uint16_t n) {
-  if (pixels) free(pixels); // Free existing data (if any)
+// Change the number of pixels.  Pixel data within the new length is kept
+// and pixels past the old length are cleared.  No allocation happens as
+// long as the new length fits in the reserved capacity.
+void Adafruit_NeoPixel::updateLength(uint32_t n) {
+  uint32_t bytes = storageBytes(n);
 
-  // Allocate new data -- note: ALL PIXELS ARE CLEARED
-  numBytes = n * ((type == SK6812RGBW) ? 4 : 3);
-  if ((pixels = (uint8_t *)malloc(numBytes))) {
-    memset(pixels, 0, numBytes);
-    numLEDs = n;
-  } else {
-    numLEDs = numBytes = 0;
+  if (bytes > maxBytes && !reserveBytes(bytes)) {
+    return; // Strip keeps its current length and data
+  }
+  if (bytes > numBytes && !constPixels) {
+    if (paletteBits) memset(pixels + numBytes, 0, bytes - numBytes);
+    else blankColors(pixels + numBytes, bytes - numBytes);
+  }
+  uint32_t oldBytes = numBytes;
+  numLEDs = n;
+  numBytes = bytes;
+  if (pixels16 && !resize16(oldBytes)) {
+    numLEDs = oldBytes / NEO_PIXEL_BYTES(NEO_TYPE); // Keep the old length
+    numBytes = oldBytes;
   }
+  forceRefresh();
+}
+
+// Make room for at least n pixels so that later updateLength() calls up
+// to n don't allocate.  Returns false if the memory isn't available or
+// the strip uses a fixed (static or attached) buffer that is too small.
+bool Adafruit_NeoPixel::reserve(uint32_t n) {
+  uint32_t bytes = storageBytes(n);
+  return (bytes <= maxBytes) || reserveBytes(bytes);
+}
+
+// Bytes of 'pixels' needed for n pixels: colors in wire order, or one
+// 8-bit / 4-bit palette index per pixel in palette mode
+uint32_t Adafruit_NeoPixel::storageBytes(uint32_t n) const {
+  if (paletteBits == 8) return n;
+  if (paletteBits == 4) return (n + 1) / 2;
+  return n * NEO_PIXEL_BYTES(NEO_TYPE);
+}
+
+// Grow the owned pixel buffer to 'bytes', keeping its contents
+bool Adafruit_NeoPixel::reserveBytes(uint32_t bytes) {
+  if (!ownPixels) return false;
+
+  uint8_t *p = (uint8_t *)realloc(pixels, bytes);
+  if (p == NULL) return false;
+  pixels = p;
+  maxBytes = bytes;
+  return true;
+}
+
+// Use a caller-owned buffer as pixel data.  The buffer must already be in
+// the strip's wire order (e.g. GRB for WS2812B), or hold palette indices in
+// palette mode, and stay valid while the strip uses it; show() transmits
+// straight from it.  The strip length becomes the number of whole pixels
+// in 'bytes'.
+void Adafruit_NeoPixel::attachBuffer(uint8_t* buf, uint32_t bytes) {
+  set16BitBuffer(false); // The attached data is sent as is
+  if (pixels && ownPixels) free(pixels);
+  pixels = buf;
+  ownPixels = false;
+  constPixels = false;
+  maxBytes = buf ? bytes : 0;
+  numLEDs = paletteBits ? (maxBytes * 8 / paletteBits) : (maxBytes / NEO_PIXEL_BYTES(NEO_TYPE));
+  numBytes = storageBytes(numLEDs);
+  forceRefresh();
+}
+
+// Same for a read-only buffer (e.g. a canned frame in flash).  Setters,
+// clear() and brightness scaling leave the data untouched.
+void Adafruit_NeoPixel::attachBuffer(const uint8_t* buf, uint32_t bytes) {
+  attachBuffer(const_cast<uint8_t*>(buf), bytes);
+  constPixels = true;
 }
 
 void Adafruit_NeoPixel::begin(void) {
+  if (neoPixelType(NEO_TYPE).timing == NEO_TIMING_CLOCKED) {
+#ifndef NEO_NO_CLOCKED
+    // Clock and data on SCK and MOSI, no SS
+    spi_->setBitOrder(MSBFIRST);
+    spi_->setDataMode(SPI_MODE0);
+    spi_->begin(PIN_INVALID);
+    spi_->setClockSpeed(NEO_SPI_CLOCK);
+    begun = true;
+    forceRefresh();
+#endif
+    return;
+  }
 #if (PLATFORM_ID == 32)
-  if (getType() == WS2812B) {
+  if (neoPixelType(NEO_TYPE).timing == NEO_TIMING_800KHZ) {
     if (spi_->interface() >= HAL_PLATFORM_SPI_NUM) {
       Log.error("SPI/SPI1 interface not defined!");
       return;
@@ -172,25 +464,61 @@ void Adafruit_NeoPixel::begin(void) {
 #else
   pinMode(pin, OUTPUT);
   digitalWrite(pin, LOW);
+#if HAL_PLATFORM_NRF52840
+  claimPwm();
+#endif
 #endif // #if (PLATFORM_ID == 32)
   begun = true;
+  forceRefresh();
 }
 
 // Set the output pin number
 void Adafruit_NeoPixel::setPin(uint8_t p) {
+    if (spi_) return; // The SPI interface owns the pins
+#if HAL_PLATFORM_NRF52840
+    releasePwm();
+#endif
     if (begun) {
         pinMode(pin, INPUT);
     }
     pin = p;
+    forceRefresh();
     if (begun) {
         pinMode(p, OUTPUT);
         digitalWrite(p, LOW);
+#if HAL_PLATFORM_NRF52840
+        claimPwm();
+#endif
     }
 }
 
 void Adafruit_NeoPixel::show(void) {
   if(!pixels) return;
 
+  // Temporal dithering changes the output every frame
+  if(pixels16 && ditherMode != NEO_DITHER_NONE) forceRefresh();
+  if(skipUnchanged && dirtyFirst >= dirtyEnd) {
+    skippedFrames++; // The strip already shows this frame
+    return;
+  }
+
+  // Pixels changed since the last frame, for backends that only re-encode
+  // those.  The frame counts as sent from here on; paths that fail to
+  // send it mark it dirty again.
+  uint32_t dirtyFrom = dirtyFirst;
+  uint32_t dirtyTo = (dirtyEnd < numLEDs) ? dirtyEnd : numLEDs;
+  dirtyFirst = UINT32_MAX;
+  dirtyEnd = 0;
+
+  if(pixels16) reduce16(); // Render the 16-bit buffer into 'pixels'
+
+  if(neoPixelType(NEO_TYPE).timing == NEO_TIMING_CLOCKED) {
+#ifndef NEO_NO_CLOCKED
+    showClocked(); // No latch time to wait for
+#endif
+    return;
+  }
+
 #if (PLATFORM_ID != 32)
   // Data latch = 24 or 50 microsecond pause in the output stream.  Rather than
   // put a delay at the end of the function, the ending time is noted and
@@ -198,725 +526,831 @@ void Adafruit_NeoPixel::show(void) {
   // subsequent round of data until the latch time has elapsed.  This
   // allows the mainline code to start generating the next frame of data
   // rather than stalling for the latch.
-  uint32_t wait_time; // wait time in microseconds.
-  switch(type) {
-    case TM1803: { // TM1803 = 24us reset pulse
-        wait_time = 24L;
-      } break;
-    case SK6812RGBW: { // SK6812RGBW = 80us reset pulse
-        wait_time = 80L;
-      } break;
-    case TM1829: { // TM1829 = 500us reset pulse
-        wait_time = 500L;
-      } break;
-    case WS2812B: // WS2812, WS2812B & WS2813 = 300us reset pulse
-    case WS2812B2: {
-        wait_time = 300L;
-      } break;
-    case WS2811: // WS2811, WS2812B_FAST & WS2812B2_FAST = 50us reset pulse
-    case WS2812B_FAST:
-    case WS2812B2_FAST:
-    default: {   // default = 50us reset pulse
-        wait_time = 50L;
-      } break;
-  }
+  uint32_t wait_time = getTiming().resetUs; // wait time in microseconds.
   while((micros() - endTime) < wait_time);
   // endTime is a private member (rather than global var) so that multiple
   // instances on different pins can be quickly issued in succession (each
   // instance doesn't delay the next).
 #endif // (PLATFORM_ID != 32)
 
+#if (PLATFORM_ID == 32) || HAL_PLATFORM_NRF52840
+  // Size of the frame on the wire; differs from numBytes in palette mode
+  uint32_t wireBytes = numLEDs * NEO_PIXEL_BYTES(NEO_TYPE);
+#endif
+
 #if (PLATFORM_ID == 0) || (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Core (0), Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-  __disable_irq(); // Need 100% focus on instruction timing
+  // The cycle counter keeps running with interrupts off, so it is used to
+  // measure how long SysTick was blocked for this frame.
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  // Every edge is timed against the cycle counter: each bit starts one bit
+  // period after the previous one and its high time is counted from that
+  // start, so loop overhead never adds up and the counts follow the clock
+  // (72MHz Core, 120MHz Photon/P1/Electron/Duo).
+  NeoTiming t = getTiming();
+  uint32_t
+    cyclesPerUs = SystemCoreClock / 1000000UL,
+    cycT0H      = t.t0hNs * cyclesPerUs / 1000UL,
+    cycT1H      = t.t1hNs * cyclesPerUs / 1000UL,
+    cycPeriod   = t.periodNs * cyclesPerUs / 1000UL;
+  // Palette and white lookups that don't fit between two bits are done
+  // for the whole frame now, while interrupts are still on
+  uint8_t *frame = expandFrame(cycPeriod - cycT1H);
 
-  volatile uint32_t
-    c,    // 24-bit/32-bit pixel color
-    mask; // 1-bit mask
-  volatile uint16_t i = numBytes; // Output loop counter
-  volatile uint8_t
-    j,              // 8-bit inner loop counter
-   *ptr = pixels,   // Pointer to next byte
-    g,              // Current green byte value
-    r,              // Current red byte value
-    b,              // Current blue byte value
-    w;              // Current white byte value
-
-  if(type == WS2812B || type == WS2812B_FAST) { // Same as WS2812 & WS2813, 800 KHz bitstream
-    while(i) { // While bytes left... (3 bytes = 1 pixel)
-      mask = 0x800000; // reset the mask
-      i = i-3;      // decrement bytes remaining
-      g = *ptr++;   // Next green byte value
-      r = *ptr++;   // Next red byte value
-      b = *ptr++;   // Next blue byte value
-      c = ((uint32_t)g << 16) | ((uint32_t)r <<  8) | b; // Pack the next 3 bytes to keep timing tight
-      j = 0;        // reset the 24-bit counter
-      do {
-        pinSet(pin, HIGH); // HIGH
-        if (c & mask) { // if masked bit is high
-          // WS2812 spec             700ns HIGH
-          // Adafruit on Arduino    (meas. 812ns)
-          // This lib on Spark Core (meas. 804ns)
-          // This lib on Photon     (meas. 792ns)
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t"
+  __disable_irq(); // Need 100% focus on instruction timing
+  uint32_t irqOffStart = DWT->CYCCNT;
+
+#ifndef NEO_STM32_DWT
+  // Plain frames go out through the hand-tuned loops, which were timed on
+  // hardware.  Custom timing and per-pixel lookups (palette, white
+  // extraction) take the cycle-counted kernel below, which every frame
+  // uses when built with NEO_STM32_DWT.
+  if(!customTiming && !paletteBits && !whiteColor) {
+    volatile uint32_t
+      c,    // 24-bit/32-bit pixel color
+      mask; // 1-bit mask
+    volatile uint32_t i = numBytes; // Output loop counter
+    volatile uint8_t
+      j,              // 8-bit inner loop counter
+     *ptr = pixels,   // Pointer to next byte
+      g,              // Current green byte value
+      r,              // Current red byte value
+      b,              // Current blue byte value
+      w;              // Current white byte value
+
+    uint8_t timing = neoPixelType(NEO_TYPE).timing;
+    uint8_t bits; // Bits in the current group of up to 3 bytes
+
+    if(timing == NEO_TIMING_800KHZ && NEO_TYPE != WS2812B2 && NEO_TYPE != WS2812B2_FAST) { // Same as WS2812 & WS2813, 800 KHz bitstream
+      while(i) { // While bytes left... (3 bytes = 1 RGB pixel, other layouts just continue in the next group)
+        bits = (i < 3) ? i * 8 : 24;
+        mask = 1UL << (bits - 1); // reset the mask
+        i = i - bits / 8; // decrement bytes remaining
+        g = *ptr++;   // Next green byte value
+        r = (bits > 8) ? *ptr++ : 0;  // Next red byte value
+        b = (bits > 16) ? *ptr++ : 0; // Next blue byte value
+        c = ((uint32_t)g << 16) | ((uint32_t)r <<  8) | b; // Pack the next 3 bytes to keep timing tight
+        c >>= 24 - bits;
+        j = 0;        // reset the 24-bit counter
+        do {
+          pinSet(pin, HIGH); // HIGH
+          if (c & mask) { // if masked bit is high
+            // WS2812 spec             700ns HIGH
+            // Adafruit on Arduino    (meas. 812ns)
+            // This lib on Spark Core (meas. 804ns)
+            // This lib on Photon     (meas. 792ns)
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-          // WS2812 spec             600ns LOW
-          // Adafruit on Arduino    (meas. 436ns)
-          // This lib on Spark Core (meas. 446ns)
-          // This lib on Photon     (meas. 434ns)
-          pinSet(pin, LOW); // LOW
-          asm volatile(
-            "mov r0, r0" "\n\t"
+              ::: "r0", "cc", "memory");
+            // WS2812 spec             600ns LOW
+            // Adafruit on Arduino    (meas. 436ns)
+            // This lib on Spark Core (meas. 446ns)
+            // This lib on Photon     (meas. 434ns)
+            pinSet(pin, LOW); // LOW
+            asm volatile(
+              "mov r0, r0" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-        }
-        else { // else masked bit is low
-          // WS2812 spec             350ns HIGH
-          // Adafruit on Arduino    (meas. 312ns)
-          // This lib on Spark Core (meas. 318ns)
-          // This lib on Photon     (meas. 308ns)
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+          }
+          else { // else masked bit is low
+            // WS2812 spec             350ns HIGH
+            // Adafruit on Arduino    (meas. 312ns)
+            // This lib on Spark Core (meas. 318ns)
+            // This lib on Photon     (meas. 308ns)
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-          // WS2812 spec             800ns LOW
-          // Adafruit on Arduino    (meas. 938ns)
-          // This lib on Spark Core (meas. 944ns)
-          // This lib on Photon     (meas. 936ns)
-          pinSet(pin, LOW); // LOW
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+            // WS2812 spec             800ns LOW
+            // Adafruit on Arduino    (meas. 938ns)
+            // This lib on Spark Core (meas. 944ns)
+            // This lib on Photon     (meas. 936ns)
+            pinSet(pin, LOW); // LOW
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-        }
-        mask >>= 1;
-      } while ( ++j < 24 ); // ... pixel done
-    } // end while(i) ... no more pixels
-  }
-  else if(type == SK6812RGBW) { // similar to WS2812, 800 KHz bitstream but with RGB+W components
-    while(i) { // While bytes left... (4 bytes = 1 pixel)
-      mask = 0x80000000; // reset the mask
-      i = i-4;      // decrement bytes remaining
-      r = *ptr++;   // Next red byte value
-      g = *ptr++;   // Next green byte value
-      b = *ptr++;   // Next blue byte value
-      w = *ptr++;   // Next white byte value
-      c = ((uint32_t)r << 24) | ((uint32_t)g << 16) | ((uint32_t)b <<  8) | w; // Pack the next 4 bytes to keep timing tight
-      j = 0;        // reset the 32-bit counter
-      do {
-        pinSet(pin, HIGH); // HIGH
-        if (c & mask) { // if masked bit is high
-          // SK6812RGBW spec         600ns HIGH
-          // WS2812 spec             700ns HIGH
-          // Adafruit on Arduino    (meas. 812ns)
-          // This lib on Spark Core (meas. 610ns)
-          // This lib on Photon     (meas. 608ns)
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+          }
+          mask >>= 1;
+        } while ( ++j < bits ); // ... pixel done
+      } // end while(i) ... no more pixels
+    }
+    else if(timing == NEO_TIMING_SK6812) { // similar to WS2812, 800 KHz bitstream but with RGB+W components
+      while(i) { // While bytes left... (4 bytes = 1 pixel)
+        mask = 0x80000000; // reset the mask
+        i = i-4;      // decrement bytes remaining
+        r = *ptr++;   // Next red byte value
+        g = *ptr++;   // Next green byte value
+        b = *ptr++;   // Next blue byte value
+        w = *ptr++;   // Next white byte value
+        c = ((uint32_t)r << 24) | ((uint32_t)g << 16) | ((uint32_t)b <<  8) | w; // Pack the next 4 bytes to keep timing tight
+        j = 0;        // reset the 32-bit counter
+        do {
+          pinSet(pin, HIGH); // HIGH
+          if (c & mask) { // if masked bit is high
+            // SK6812RGBW spec         600ns HIGH
+            // WS2812 spec             700ns HIGH
+            // Adafruit on Arduino    (meas. 812ns)
+            // This lib on Spark Core (meas. 610ns)
+            // This lib on Photon     (meas. 608ns)
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-          // SK6812RGBW spec         600ns LOW
-          // WS2812 spec             600ns LOW
-          // Adafruit on Arduino    (meas. 436ns)
-          // This lib on Spark Core (meas. 598ns)
-          // This lib on Photon     (meas. 600ns)
-          pinSet(pin, LOW); // LOW
-          asm volatile(
-            "mov r0, r0" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+            // SK6812RGBW spec         600ns LOW
+            // WS2812 spec             600ns LOW
+            // Adafruit on Arduino    (meas. 436ns)
+            // This lib on Spark Core (meas. 598ns)
+            // This lib on Photon     (meas. 600ns)
+            pinSet(pin, LOW); // LOW
+            asm volatile(
+              "mov r0, r0" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-        }
-        else { // else masked bit is low
-          // SK6812RGBW spec         300ns HIGH
-          // WS2812 spec             350ns HIGH
-          // Adafruit on Arduino    (meas. 312ns)
-          // This lib on Spark Core (meas. 305ns)
-          // This lib on Photon     (meas. 308ns)
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+          }
+          else { // else masked bit is low
+            // SK6812RGBW spec         300ns HIGH
+            // WS2812 spec             350ns HIGH
+            // Adafruit on Arduino    (meas. 312ns)
+            // This lib on Spark Core (meas. 305ns)
+            // This lib on Photon     (meas. 308ns)
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-          // SK6812RGBW spec         900ns LOW
-          // WS2812 spec             800ns LOW
-          // Adafruit on Arduino    (meas. 938ns)
-          // This lib on Spark Core (meas. 904ns)
-          // This lib on Photon     (meas. 900ns)
-          pinSet(pin, LOW); // LOW
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+            // SK6812RGBW spec         900ns LOW
+            // WS2812 spec             800ns LOW
+            // Adafruit on Arduino    (meas. 938ns)
+            // This lib on Spark Core (meas. 904ns)
+            // This lib on Photon     (meas. 900ns)
+            pinSet(pin, LOW); // LOW
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-        }
-        mask >>= 1;
-      } while ( ++j < 32 ); // ... pixel done
-    } // end while(i) ... no more pixels
-  }
-  else if(type == WS2812B2 || type == WS2812B2_FAST) { // WS2812B with DWT timer
+              ::: "r0", "cc", "memory");
+          }
+          mask >>= 1;
+        } while ( ++j < 32 ); // ... pixel done
+      } // end while(i) ... no more pixels
+    }
+    else if(timing == NEO_TIMING_800KHZ) { // WS2812B2 and WS2812B2_FAST: WS2812B with DWT timer
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-    #define CYCLES_800_T0H  25 // 312ns (meas. 300ns)
-    #define CYCLES_800_T0L  70 // 938ns (meas. 940ns)
-    #define CYCLES_800_T1H  80 // 812ns (meas. 792ns)
-    #define CYCLES_800_T1L  8  // 436ns (meas. 425ns)
-
-    volatile uint32_t cyc;
-
-    while(i) { // While bytes left... (3 bytes = 1 pixel)
-      mask = 0x800000; // reset the mask
-      i = i-3;      // decrement bytes remaining
-      g = *ptr++;   // Next green byte value
-      r = *ptr++;   // Next red byte value
-      b = *ptr++;   // Next blue byte value
-      c = ((uint32_t)g << 16) | ((uint32_t)r <<  8) | b; // Pack the next 3 bytes to keep timing tight
-      j = 0;        // reset the 24-bit counter
-      do {
-        cyc = DWT->CYCCNT;
-        pinSet(pin, HIGH); // HIGH
-        if (c & mask) { // if masked bit is high
-          while(DWT->CYCCNT - cyc < CYCLES_800_T1H);
-          pinSet(pin, LOW);
+#define CYCLES_800_T0H  25 // 312ns (meas. 300ns)
+#define CYCLES_800_T0L  70 // 938ns (meas. 940ns)
+#define CYCLES_800_T1H  80 // 812ns (meas. 792ns)
+#define CYCLES_800_T1L  8  // 436ns (meas. 425ns)
+
+      volatile uint32_t cyc;
+
+      while(i) { // While bytes left... (3 bytes = 1 RGB pixel, other layouts just continue in the next group)
+        bits = (i < 3) ? i * 8 : 24;
+        mask = 1UL << (bits - 1); // reset the mask
+        i = i - bits / 8; // decrement bytes remaining
+        g = *ptr++;   // Next green byte value
+        r = (bits > 8) ? *ptr++ : 0;  // Next red byte value
+        b = (bits > 16) ? *ptr++ : 0; // Next blue byte value
+        c = ((uint32_t)g << 16) | ((uint32_t)r <<  8) | b; // Pack the next 3 bytes to keep timing tight
+        c >>= 24 - bits;
+        j = 0;        // reset the 24-bit counter
+        do {
           cyc = DWT->CYCCNT;
-          while(DWT->CYCCNT - cyc < CYCLES_800_T1L);
-        }
-        else { // else masked bit is low
-          while(DWT->CYCCNT - cyc < CYCLES_800_T0H);
-          pinSet(pin, LOW);
-          cyc = DWT->CYCCNT;
-          while(DWT->CYCCNT - cyc < CYCLES_800_T0L);
-        }
-        mask >>= 1;
-      } while ( ++j < 24 ); // ... pixel done
-    } // end while(i) ... no more pixels
+          pinSet(pin, HIGH); // HIGH
+          if (c & mask) { // if masked bit is high
+            while(DWT->CYCCNT - cyc < CYCLES_800_T1H);
+            pinSet(pin, LOW);
+            cyc = DWT->CYCCNT;
+            while(DWT->CYCCNT - cyc < CYCLES_800_T1L);
+          }
+          else { // else masked bit is low
+            while(DWT->CYCCNT - cyc < CYCLES_800_T0H);
+            pinSet(pin, LOW);
+            cyc = DWT->CYCCNT;
+            while(DWT->CYCCNT - cyc < CYCLES_800_T0L);
+          }
+          mask >>= 1;
+        } while ( ++j < bits ); // ... pixel done
+      } // end while(i) ... no more pixels
 #endif
-  }
-  else if(type == WS2811) { // WS2811, 400 KHz bitstream
-    while(i) { // While bytes left... (3 bytes = 1 pixel)
-      mask = 0x800000; // reset the mask
-      i = i-3;      // decrement bytes remaining
-      r = *ptr++;   // Next red byte value
-      g = *ptr++;   // Next green byte value
-      b = *ptr++;   // Next blue byte value
-      c = ((uint32_t)r << 16) | ((uint32_t)g <<  8) | b; // Pack the next 3 bytes to keep timing tight
-      j = 0;        // reset the 24-bit counter
-      do {
-        pinSet(pin, HIGH); // HIGH
-        if (c & mask) { // if masked bit is high
-          // WS2811 spec             1.20us HIGH
-          // Adafruit on Arduino    (meas. 1.25us)
-          // This lib on Spark Core (meas. 1.25us)
-          // This lib on Photon     (meas. 1.25us)
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+    }
+    else if(timing == NEO_TIMING_400KHZ) { // WS2811, 400 KHz bitstream
+      while(i) { // While bytes left... (3 bytes = 1 pixel)
+        mask = 0x800000; // reset the mask
+        i = i-3;      // decrement bytes remaining
+        r = *ptr++;   // Next red byte value
+        g = *ptr++;   // Next green byte value
+        b = *ptr++;   // Next blue byte value
+        c = ((uint32_t)r << 16) | ((uint32_t)g <<  8) | b; // Pack the next 3 bytes to keep timing tight
+        j = 0;        // reset the 24-bit counter
+        do {
+          pinSet(pin, HIGH); // HIGH
+          if (c & mask) { // if masked bit is high
+            // WS2811 spec             1.20us HIGH
+            // Adafruit on Arduino    (meas. 1.25us)
+            // This lib on Spark Core (meas. 1.25us)
+            // This lib on Photon     (meas. 1.25us)
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-          // WS2811 spec             1.30us LOW
-          // Adafruit on Arduino    (meas. 1.25us)
-          // This lib on Spark Core (meas. 1.24us)
-          // This lib on Photon     (meas. 1.24us)
-          pinSet(pin, LOW); // LOW
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+            // WS2811 spec             1.30us LOW
+            // Adafruit on Arduino    (meas. 1.25us)
+            // This lib on Spark Core (meas. 1.24us)
+            // This lib on Photon     (meas. 1.24us)
+            pinSet(pin, LOW); // LOW
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-        }
-        else { // else masked bit is low
-          // WS2811 spec             500ns HIGH
-          // Adafruit on Arduino    (meas. 500ns)
-          // This lib on Spark Core (meas. 500ns)
-          // This lib on Photon     (meas. 500ns)
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+          }
+          else { // else masked bit is low
+            // WS2811 spec             500ns HIGH
+            // Adafruit on Arduino    (meas. 500ns)
+            // This lib on Spark Core (meas. 500ns)
+            // This lib on Photon     (meas. 500ns)
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #endif
-            "nop" "\n\t" "nop" "\n\t"
-            ::: "r0", "cc", "memory");
-          // WS2811 spec             2.000us LOW
-          // Adafruit on Arduino    (meas. 2.000us)
-          // This lib on Spark Core (meas. 2.000us)
-          // This lib on Photon     (meas. 2.000us)
-          pinSet(pin, LOW); // LOW
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+            // WS2811 spec             2.000us LOW
+            // Adafruit on Arduino    (meas. 2.000us)
+            // This lib on Spark Core (meas. 2.000us)
+            // This lib on Photon     (meas. 2.000us)
+            pinSet(pin, LOW); // LOW
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-        }
-        mask >>= 1;
-      } while ( ++j < 24 ); // ... pixel done
-    } // end while(i) ... no more pixels
-  }
-  else if(type == TM1803) { // TM1803 (Radio Shack Tri-Color Strip), 400 KHz bitstream
-    while(i) { // While bytes left... (3 bytes = 1 pixel)
-      mask = 0x800000; // reset the mask
-      i = i-3;      // decrement bytes remaining
-      r = *ptr++;   // Next red byte value
-      g = *ptr++;   // Next blue byte value
-      b = *ptr++;   // Next green byte value
-      c = ((uint32_t)r << 16) | ((uint32_t)g <<  8) | b; // Pack the next 3 bytes to keep timing tight
-      j = 0;        // reset the 24-bit counter
-      do {
-        pinSet(pin, HIGH); // HIGH
-        if (c & mask) { // if masked bit is high
-          // TM1803 spec             1.36us HIGH
-          // Pololu on Arduino      (meas. 1.31us)
-          // This lib on Spark Core (meas. 1.36us)
-          // This lib on Photon     (meas. 1.36us)
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+          }
+          mask >>= 1;
+        } while ( ++j < 24 ); // ... pixel done
+      } // end while(i) ... no more pixels
+    }
+    else if(timing == NEO_TIMING_TM1803) { // TM1803 (Radio Shack Tri-Color Strip), 400 KHz bitstream
+      while(i) { // While bytes left... (3 bytes = 1 pixel)
+        mask = 0x800000; // reset the mask
+        i = i-3;      // decrement bytes remaining
+        r = *ptr++;   // Next red byte value
+        g = *ptr++;   // Next blue byte value
+        b = *ptr++;   // Next green byte value
+        c = ((uint32_t)r << 16) | ((uint32_t)g <<  8) | b; // Pack the next 3 bytes to keep timing tight
+        j = 0;        // reset the 24-bit counter
+        do {
+          pinSet(pin, HIGH); // HIGH
+          if (c & mask) { // if masked bit is high
+            // TM1803 spec             1.36us HIGH
+            // Pololu on Arduino      (meas. 1.31us)
+            // This lib on Spark Core (meas. 1.36us)
+            // This lib on Photon     (meas. 1.36us)
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-          // TM1803 spec             680ns LOW
-          // Pololu on Arduino      (meas. 1.024us)
-          // This lib on Spark Core (meas. 680ns)
-          // This lib on Photon     (meas. 684ns)
-          pinSet(pin, LOW); // LOW
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+            // TM1803 spec             680ns LOW
+            // Pololu on Arduino      (meas. 1.024us)
+            // This lib on Spark Core (meas. 680ns)
+            // This lib on Photon     (meas. 684ns)
+            pinSet(pin, LOW); // LOW
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-        }
-        else { // else masked bit is low
-          // TM1803 spec             680ns HIGH
-          // Pololu on Arduino      (meas. 374ns)
-          // This lib on Spark Core (meas. 680ns)
-          // This lib on Photon     (meas. 684ns)
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+          }
+          else { // else masked bit is low
+            // TM1803 spec             680ns HIGH
+            // Pololu on Arduino      (meas. 374ns)
+            // This lib on Spark Core (meas. 680ns)
+            // This lib on Photon     (meas. 684ns)
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-          // TM1803 spec             1.36us LOW
-          // Pololu on Arduino      (meas. 2.00us)
-          // This lib on Spark Core (meas. 1.36us)
-          // This lib on Photon     (meas. 1.36us)
-          pinSet(pin, LOW); // LOW
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+            // TM1803 spec             1.36us LOW
+            // Pololu on Arduino      (meas. 2.00us)
+            // This lib on Spark Core (meas. 1.36us)
+            // This lib on Photon     (meas. 1.36us)
+            pinSet(pin, LOW); // LOW
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-        }
-        mask >>= 1;
-      } while ( ++j < 24 ); // ... pixel done
-    } // end while(i) ... no more pixels
-  }
-  else { // must be only other option TM1829, 800 KHz bitstream
-    while(i) { // While bytes left... (3 bytes = 1 pixel)
-      mask = 0x800000; // reset the mask
-      i = i-3;      // decrement bytes remaining
-      r = *ptr++;   // Next red byte value
-      b = *ptr++;   // Next blue byte value
-      g = *ptr++;   // Next green byte value
-      c = ((uint32_t)r << 16) | ((uint32_t)b <<  8) | g; // Pack the next 3 bytes to keep timing tight
-      j = 0;        // reset the 24-bit counter
-      pinSet(pin, LOW); // LOW
-      for( ;; ) {   // ... pixel done
-        if (c & mask) { // if masked bit is high
-          // TM1829 spec             800ns LOW
-          // This lib on Spark Core (meas. 806ns)
-          // This lib on Photon     (meas. 792ns)
-          mask >>= 1; // Do this task during the long delay of this bit
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+          }
+          mask >>= 1;
+        } while ( ++j < 24 ); // ... pixel done
+      } // end while(i) ... no more pixels
+    }
+    else { // must be only other option NEO_TIMING_TM1829, 800 KHz bitstream
+      while(i) { // While bytes left... (3 bytes = 1 pixel)
+        mask = 0x800000; // reset the mask
+        i = i-3;      // decrement bytes remaining
+        r = *ptr++;   // Next red byte value
+        b = *ptr++;   // Next blue byte value
+        g = *ptr++;   // Next green byte value
+        c = ((uint32_t)r << 16) | ((uint32_t)b <<  8) | g; // Pack the next 3 bytes to keep timing tight
+        j = 0;        // reset the 24-bit counter
+        pinSet(pin, LOW); // LOW
+        for( ;; ) {   // ... pixel done
+          if (c & mask) { // if masked bit is high
+            // TM1829 spec             800ns LOW
+            // This lib on Spark Core (meas. 806ns)
+            // This lib on Photon     (meas. 792ns)
+            mask >>= 1; // Do this task during the long delay of this bit
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-          j++;
-          // TM1829 spec             300ns HIGH
-          // This lib on Spark Core (meas. 305ns)
-          // This lib on Photon     (meas. 300ns)
-          pinSet(pin, HIGH); // HIGH
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              ::: "r0", "cc", "memory");
+            j++;
+            // TM1829 spec             300ns HIGH
+            // This lib on Spark Core (meas. 305ns)
+            // This lib on Photon     (meas. 300ns)
+            pinSet(pin, HIGH); // HIGH
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
 #endif
-            ::: "r0", "cc", "memory");
-          if(j==24) break;
-          pinSet(pin, LOW); // LOW
-        }
-        else { // else masked bit is low
-          // TM1829 spec             300ns LOW
-          // This lib on Spark Core (meas. 390ns)
-          // This lib on Photon     (meas. 300ns)
+              ::: "r0", "cc", "memory");
+            if(j==24) break;
+            pinSet(pin, LOW); // LOW
+          }
+          else { // else masked bit is low
+            // TM1829 spec             300ns LOW
+            // This lib on Spark Core (meas. 390ns)
+            // This lib on Photon     (meas. 300ns)
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-          asm volatile(
-            "mov r0, r0" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t"
-            ::: "r0", "cc", "memory");
+            asm volatile(
+              "mov r0, r0" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t"
+              ::: "r0", "cc", "memory");
 #endif
-          // TM1829 spec             800ns HIGH
-          // This lib on Spark Core (meas. 792ns)
-          // This lib on Photon     (meas. 800ns)
-          pinSet(pin, HIGH); // HIGH
-          j++;
-          mask >>= 1; // Do this task during the long delay of this bit
-          asm volatile(
-            "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+            // TM1829 spec             800ns HIGH
+            // This lib on Spark Core (meas. 792ns)
+            // This lib on Photon     (meas. 800ns)
+            pinSet(pin, HIGH); // HIGH
+            j++;
+            mask >>= 1; // Do this task during the long delay of this bit
+            asm volatile(
+              "mov r0, r0" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
 #if (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
-            "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+              "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t" "nop" "\n\t"
+#endif
+              ::: "r0", "cc", "memory");
+            if(j==24) break;
+            pinSet(pin, LOW); // LOW
+          }
+        }
+      } // end while(i) ... no more pixels
+    }
+  } else
+#endif
+  {
+    // Output register for the start of a bit and for the rest of it (the
+    // idle level).  TM1829 bits are inverted: low pulses on a high line.
+#if PLATFORM_ID == 0 // Core (0)
+    auto
+     *active = &PIN_MAP[pin].gpio_peripheral->BSRR,
+     *idle   = &PIN_MAP[pin].gpio_peripheral->BRR;
+    uint32_t pinBit = PIN_MAP[pin].gpio_pin;
+#else
+    auto
+     *active = &PIN_MAP2[pin].gpio_peripheral->BSRRL,
+     *idle   = &PIN_MAP2[pin].gpio_peripheral->BSRRH;
+    uint16_t pinBit = PIN_MAP2[pin].gpio_pin;
 #endif
-            ::: "r0", "cc", "memory");
-          if(j==24) break;
-          pinSet(pin, LOW); // LOW
+    if(neoPixelType(NEO_TYPE).timing == NEO_TIMING_TM1829) {
+      auto swap = active;
+      active = idle;
+      idle = swap;
+    }
+
+    // 'cyc' is the scheduled start of the current bit; it steps by exactly
+    // one period, the time spent noticing the end of the wait isn't added.
+    // Each pixel is looked up in the low time of the bit before it, unless
+    // the frame was expanded above; if that runs over anyway, the low time
+    // is stretched and the schedule restarts.
+    uint8_t bpp = NEO_PIXEL_BYTES(NEO_TYPE), buf[NEO_CH_MAX * 2];
+    uint32_t cyc = DWT->CYCCNT - cycPeriod;
+    for(uint32_t n = 0; n < numLEDs; n++) {
+      const uint8_t *ptr = frame ? &frame[n * bpp] : wirePixel(n, buf), *end = ptr + bpp;
+      if(DWT->CYCCNT - cyc > cycPeriod) cyc = DWT->CYCCNT - cycPeriod;
+      while(ptr < end) {
+        uint32_t c = *ptr++;
+        for(uint32_t mask = 0x80; mask; mask >>= 1) {
+          uint32_t high = (c & mask) ? cycT1H : cycT0H;
+          while(DWT->CYCCNT - cyc < cycPeriod);
+          cyc += cycPeriod;
+          *active = pinBit;
+          while(DWT->CYCCNT - cyc < high);
+          *idle = pinBit;
         }
       }
-    } // end while(i) ... no more pixels
+    }
+    while(DWT->CYCCNT - cyc < cycPeriod); // Last bit's low time
   }
 
+  irqBlackout(DWT->CYCCNT - irqOffStart);
   __enable_irq();
+  if(frame != encodeBuf) free(frame);
 
 #elif (PLATFORM_ID == 32)
-  if (getType() != WS2812B) { // WS2812 WS2812B and WS2813 supported for P2
+  if (neoPixelType(NEO_TYPE).timing != NEO_TIMING_800KHZ) { // Only WS2812 timing supported for P2
     Log.error("Pixel type not supported!");
     return;
   }
 
-  constexpr uint8_t PIX_HI = 0b110;
-  constexpr uint8_t PIX_LO = 0b100;
+  // Each data bit is 3 SPI bits (0b110 = 1, 0b100 = 0), so the SPI clock
+  // sets the bit period; a custom T0H and T1H round to 1/3 and 2/3 of it.
+  uint32_t spiClock = customTiming ? (3000000000UL / profile.periodNs) : 3125000UL;
+  spi_->setClockSpeed(spiClock);
 
-  uint16_t resetOff = 120; // 300us / (1/3125000Mhz) / 8bits_per_byte
-  switch (type) {
-    case WS2812B: { // WS2812, WS2812B & WS2813 = 300us reset pulse
-        resetOff = 120;
-      } break;
-    case WS2812B_FAST: // WS2812B_FAST = 50us reset pulse
-    default: {   // default = 50us reset pulse
-        resetOff = 20;
-      } break;
-  }
+  // e.g. 300us / (1/3125000Mhz) / 8bits_per_byte = 118 bytes of zeros
+  uint32_t resetOff = (getTiming().resetUs * (spiClock / 1000UL) + 7999UL) / 8000UL;
 
   constexpr uint8_t numBitsPerBit = 3; // How many SPI bits represent one neopixel bit
-  uint32_t spiArraySize = (numBytes * numBitsPerBit) + resetOff + resetOff;
+  // Chunks hold whole pixels so palette indices can be expanded per chunk
+  uint32_t chunkPixels = NEO_CHUNK_BYTES / NEO_PIXEL_BYTES(NEO_TYPE);
+  uint32_t chunkBytes = chunkPixels * NEO_PIXEL_BYTES(NEO_TYPE);
+  // Long strips are encoded into two chunk buffers that alternate while
+  // DMA sends the other, whatever buffer they use, so neither the buffer
+  // nor a single transfer grows with the strip.  The reset periods are
+  // sent separately.
+  bool chunked = wireBytes > 2 * chunkBytes;
+  // A cached frame goes out in one transfer, so only frames within the 64K
+  // DMA limit are cached.
+  bool cached = false;
+  uint8_t* slot = (wireBytes * numBitsPerBit <= 0xFFFC) ?
+                  cacheFrame(wireBytes * numBitsPerBit, cached) : NULL;
+  if (slot) chunked = false;
+  uint32_t spiArraySize = (chunked ? 2 * chunkBytes : wireBytes) * numBitsPerBit;
   uint8_t* spiArray = NULL;
-  spiArray = (uint8_t*) malloc(spiArraySize);
+  if (slot) {
+    spiArray = slot;
+  } else if (encodeBuf && spiArraySize <= encodeBytes) {
+    spiArray = encodeBuf;
+  } else {
+    spiArray = (uint8_t*) malloc(spiArraySize);
+  }
 
   if (spiArray == NULL) {
     Log.error("Not enough memory available!");
+    forceRefresh();
     return;
   }
 
-  memset(spiArray, 0, spiArraySize);
-  // expand pixel data and pack into spi buffer
-  for (int x = 0; x < numPixels(); x++) {
-    for (int s = 0; s < 3; s++) {
-      spiArray[(x*9)+(s*3)+0+resetOff] = ((0x80 & pixels[(x*3)+s])?(PIX_HI << 5):(PIX_LO << 5)) + ((0x40 & pixels[(x*3)+s])?(PIX_HI << 2):(PIX_LO << 2)) + ((0x20 & pixels[(x*3)+s])?(0b11):(0b10));
-      spiArray[(x*9)+(s*3)+1+resetOff] = 0 /* bit 7 always 0 */ + ((0x10 & pixels[(x*3)+s])?(PIX_HI << 4):(PIX_LO << 4)) + ((0x08 & pixels[(x*3)+s])?(PIX_HI << 1):(PIX_LO << 1)) + 1 /* bit 0 always 1 */;
-      spiArray[(x*9)+(s*3)+2+resetOff] = ((0x04 & pixels[(x*3)+s])?(0b10 << 6):(0b00 << 6)) + ((0x02 & pixels[(x*3)+s])?(PIX_HI << 3):(PIX_LO << 3)) + ((0x01 & pixels[(x*3)+s])?(PIX_HI):(PIX_LO));
+  spi_->beginTransaction();
+  spiSendZeros(spi_, resetOff); // leading reset
+  if (!chunked) {
+    // expand pixel data and pack into spi buffer.  With skipUnchanged the
+    // fixed buffer still holds the last frame, so only the pixels changed
+    // since then need encoding.
+    // A cache hit is sent as is.
+    uint32_t first = 0, count = cached ? 0 : numLEDs;
+    if (skipUnchanged && spiArray == encodeBuf && !cachePool) {
+      first = dirtyFrom;
+      count = (dirtyTo > dirtyFrom) ? dirtyTo - dirtyFrom : 0;
+    }
+    encodePixels(encodeSpi, numBitsPerBit,
+                 spiArray + first * NEO_PIXEL_BYTES(NEO_TYPE) * numBitsPerBit, first, count);
+    spi_->transfer(spiArray, nullptr, spiArraySize, nullptr);
+  } else {
+    // A thread switch between chunks would hold the line low for longer
+    // than the reset time and latch half a frame.
+    SINGLE_THREADED_BLOCK() {
+      uint8_t* chunk[2] = { spiArray, spiArray + chunkBytes * numBitsPerBit };
+      uint32_t done = 0;
+      uint8_t k = 0;
+      spiChunkDone = true;
+      while (done < numLEDs) {
+        uint32_t len = numLEDs - done;
+        if (len > chunkPixels) len = chunkPixels;
+        encodePixels(encodeSpi, numBitsPerBit, chunk[k], done, len);
+        done += len;
+        while (!spiChunkDone); // previous chunk still being sent
+        spiChunkDone = false;
+        spi_->transfer(chunk[k], nullptr, len * NEO_PIXEL_BYTES(NEO_TYPE) * numBitsPerBit,
+                       spiChunkComplete);
+        k ^= 1;
+      }
+      while (!spiChunkDone);
     }
   }
-
-  spi_->beginTransaction();
-  spi_->transfer(spiArray, nullptr, spiArraySize, nullptr);
+  spiSendZeros(spi_, resetOff); // trailing reset
   spi_->endTransaction();
 
-  free(spiArray);
+  if (spiArray != encodeBuf && spiArray != slot) free(spiArray);
 
 #elif HAL_PLATFORM_NRF52840 // Argon, Boron, Xenon, B SoM, B5 SoM, E SoM X, Tracker
 // [[[Begin of the Neopixel NRF52 EasyDMA implementation
@@ -963,17 +1397,8 @@ void Adafruit_NeoPixel::show(void) {
 // The nRF52832 runs with a fixed clock of 64Mhz. The alternative
 // implementation is the same as the one used for the Teensy 3.0/1/2 but
 // with the Nordic SDK HAL & registers syntax.
-// The number of cycles was hand picked and is guaranteed to be 100% 
-// organic to preserve freshness and high accuracy.
-// ---------- BEGIN Constants for cycle counter implementation ---------
-#define CYCLES_800_T0H  18  // ~0.36 uS
-#define CYCLES_800_T1H  41  // ~0.76 uS
-#define CYCLES_800      71  // ~1.25 uS
-
-#define CYCLES_400_T0H  26  // ~0.50 uS
-#define CYCLES_400_T1H  70  // ~1.26 uS
-#define CYCLES_400      156 // ~2.50 uS
-// ---------- END of Constants for cycle counter implementation --------
+// Its cycle counts are worked out from getTiming() at the CPU clock, like
+// the PWM compare values.
 
   // To support both the SoftDevice + Neopixels we use the EasyDMA
   // feature from the NRF25. However this technique implies to
@@ -985,28 +1410,42 @@ void Adafruit_NeoPixel::show(void) {
   //
   // If there is not enough memory, we will fall back to cycle counter
   // using DWT
-  uint32_t  pattern_size   = numBytes*8*sizeof(uint16_t)+2*sizeof(uint16_t);
+#ifndef NEO_NO_PWM
+  uint32_t  pattern_size   = wireBytes*8*sizeof(uint16_t)+2*sizeof(uint16_t);
   uint16_t* pixels_pattern = NULL;
 
-  NRF_PWM_Type* pwm = NULL;
-
-  // Try to find a free PWM device, which is not enabled
-  // and has no connected pins
-  NRF_PWM_Type* PWM[3] = {NRF_PWM0, NRF_PWM1, NRF_PWM2};
-  for(int device = 0; device<3; device++) {
-    if( (PWM[device]->ENABLE == 0)                            &&
-        (PWM[device]->PSEL.OUT[0] & PWM_PSEL_OUT_CONNECT_Msk) &&
-        (PWM[device]->PSEL.OUT[1] & PWM_PSEL_OUT_CONNECT_Msk) &&
-        (PWM[device]->PSEL.OUT[2] & PWM_PSEL_OUT_CONNECT_Msk) &&
-        (PWM[device]->PSEL.OUT[3] & PWM_PSEL_OUT_CONNECT_Msk)
-    ) {
-      pwm = PWM[device];
-      break;
-    }
+  // Chunks hold whole pixels so palette indices can be expanded per chunk
+  uint32_t  chunkPixels    = NEO_CHUNK_BYTES / NEO_PIXEL_BYTES(NEO_TYPE);
+  uint32_t  chunkBytes     = chunkPixels * NEO_PIXEL_BYTES(NEO_TYPE);
+
+  // Long strips are sent in chunks from two alternating half buffers,
+  // whatever buffer they use: SEQ[n].CNT only holds 15 bits.
+  bool      chunked        = wireBytes > 2*chunkBytes;
+
+  // The PWM device is normally claimed and configured in begin() and kept
+  // across frames.  Try again here in case none was free at that time.
+  if ( pwm == NULL ) claimPwm();
+
+  // Frames in the cache (see setFrameCache()) are sent without encoding,
+  // as one sequence, so only frames that fit SEQ[0].CNT are cached.
+  bool      cached         = false;
+  uint8_t*  slot           = NULL;
+  if ( pwm != NULL &&
+       pattern_size/sizeof(uint16_t) <= (PWM_SEQ_CNT_CNT_Msk >> PWM_SEQ_CNT_CNT_Pos) ) {
+    slot = cacheFrame(pattern_size, cached);
   }
-  
-  // only malloc if there is PWM device available
-  if ( pwm != NULL ) {
+  if ( slot != NULL ) {
+    chunked = false;
+  } else if ( chunked ) {
+    pattern_size = 2*(chunkBytes*8*sizeof(uint16_t)+2*sizeof(uint16_t));
+  }
+
+  // only malloc if there is PWM device available and no fixed buffer.
+  if ( slot != NULL ) {
+    pixels_pattern = (uint16_t *) slot;
+  } else if ( pwm != NULL && encodeBuf != NULL && pattern_size <= encodeBytes ) {
+    pixels_pattern = (uint16_t *) encodeBuf;
+  } else if ( pwm != NULL ) {
     #ifdef ARDUINO_FEATHER52 // use thread-safe malloc
       pixels_pattern = (uint16_t *) rtos_malloc(pattern_size);
     #else
@@ -1017,112 +1456,145 @@ void Adafruit_NeoPixel::show(void) {
   // Use the identified device to choose the implementation
   // If a PWM device is available use DMA
   if( (pixels_pattern != NULL) && (pwm != NULL) ) {
-    uint16_t pos = 0; // bit position
-
-    for(uint16_t n=0; n<numBytes; n++) {
-      uint8_t pix = pixels[n];
-
-      for(uint8_t mask=0x80, i=0; mask>0; mask >>= 1, i++) {
-        #ifdef NEO_KHZ400
-        if( !is800KHz ) {
-          pixels_pattern[pos] = (pix & mask) ? MAGIC_T1H_400KHz : MAGIC_T0H_400KHz;
-        }else
-        #endif
-        {
-          pixels_pattern[pos] = (pix & mask) ? MAGIC_T1H : MAGIC_T0H;
-        }
-
-        pos++;
-      }
-    }
-
-    // Zero padding to indicate the end of que sequence
-    pixels_pattern[++pos] = 0 | (0x8000); // Seq end
-    pixels_pattern[++pos] = 0 | (0x8000); // Seq end
-
-    // Set the wave mode to count UP
-    pwm->MODE = (PWM_MODE_UPDOWN_Up << PWM_MODE_UPDOWN_Pos);
-
-    // Set the PWM to use the 16MHz clock
-    pwm->PRESCALER = (PWM_PRESCALER_PRESCALER_DIV_1 << PWM_PRESCALER_PRESCALER_Pos);
-
-    // Setting of the maximum count
-    // but keeping it on 16Mhz allows for more granularity just
-    // in case someone wants to do more fine-tuning of the timing.
-#ifdef NEO_KHZ400
-    if( !is800KHz ) {
-      pwm->COUNTERTOP = (CTOPVAL_400KHz << PWM_COUNTERTOP_COUNTERTOP_Pos);
-    }else
-#endif
-    {
-      pwm->COUNTERTOP = (CTOPVAL << PWM_COUNTERTOP_COUNTERTOP_Pos);
-    }
+    NRF_PWM_Type* dev = (NRF_PWM_Type*)pwm;
 
-    // Disable loops, we want the sequence to repeat only once
-    pwm->LOOP = (PWM_LOOP_CNT_Disabled << PWM_LOOP_CNT_Pos);
-
-    // On the "Common" setting the PWM uses the same pattern for the
-    // for supported sequences. The pattern is stored on half-word
-    // of 16bits
-    pwm->DECODER = (PWM_DECODER_LOAD_Common << PWM_DECODER_LOAD_Pos) |
-                   (PWM_DECODER_MODE_RefreshCount << PWM_DECODER_MODE_Pos);
-
-    // Pointer to the memory storing the patter
-    pwm->SEQ[0].PTR = (uint32_t)(pixels_pattern) << PWM_SEQ_PTR_PTR_Pos;
-
-    // Calculation of the number of steps loaded from memory.
-    pwm->SEQ[0].CNT = (pattern_size/sizeof(uint16_t)) << PWM_SEQ_CNT_CNT_Pos;
-
-    // The following settings are ignored with the current config.
-    pwm->SEQ[0].REFRESH  = 0;
-    pwm->SEQ[0].ENDDELAY = 0;
+    // The device was timed in claimPwm() or setTiming(); the nibble table
+    // is shared by all strips and only refilled if one with another timing
+    // used it last
+    setPwmPattern(pwmT0H, pwmT1H);
 
     // The Neopixel implementation is a blocking algorithm. DMA
     // allows for non-blocking operation. To "simulate" a blocking
     // operation we enable the interruption for the end of sequence
     // and block the execution thread until the event flag is set by
     // the peripheral.
-//    pwm->INTEN |= (PWM_INTEN_SEQEND0_Enabled<<PWM_INTEN_SEQEND0_Pos);
+//    dev->INTEN |= (PWM_INTEN_SEQEND0_Enabled<<PWM_INTEN_SEQEND0_Pos);
 
-    // PSEL must be configured before enabling PWM
-    pwm->PSEL.OUT[0] = NRF_GPIO_PIN_MAP(PIN_MAP2[pin].gpio_port, PIN_MAP2[pin].gpio_pin);
+    if ( !chunked ) {
+      if ( !cached ) {
+        encodePixels(encodePwm, 8*sizeof(uint16_t), (uint8_t *)pixels_pattern, 0, numLEDs);
 
-    // Enable the PWM
-    pwm->ENABLE = 1;
+        // Zero padding to indicate the end of que sequence
+        pixels_pattern[wireBytes*8]   = 0 | (0x8000); // Seq end
+        pixels_pattern[wireBytes*8+1] = 0 | (0x8000); // Seq end
+      }
 
-    // After all of this and many hours of reading the documentation
-    // we are ready to start the sequence...
-    pwm->EVENTS_SEQEND[0]  = 0;
-    pwm->TASKS_SEQSTART[0] = 1;
+      // Pointer to the memory storing the patter
+      dev->SEQ[0].PTR = (uint32_t)(uintptr_t)(pixels_pattern) << PWM_SEQ_PTR_PTR_Pos;
 
-    // But we have to wait for the flag to be set.
-    while(!pwm->EVENTS_SEQEND[0])
-    {
-      #ifdef ARDUINO_FEATHER52
-      yield();
-      #endif
-    }
+      // Calculation of the number of steps loaded from memory.
+      dev->SEQ[0].CNT = (pattern_size/sizeof(uint16_t)) << PWM_SEQ_CNT_CNT_Pos;
+
+      // The device was configured and enabled in claimPwm(), so we are
+      // ready to start the sequence...
+      dev->EVENTS_SEQEND[0]  = 0;
+      dev->TASKS_SEQSTART[0] = 1;
 
-    // Before leave we clear the flag for the event.
-    pwm->EVENTS_SEQEND[0] = 0;
+      // But we have to wait for the flag to be set.
+      while(!dev->EVENTS_SEQEND[0])
+      {
+        #ifdef ARDUINO_FEATHER52
+        yield();
+        #endif
+      }
+
+      // Before leave we clear the flag for the event.
+      dev->EVENTS_SEQEND[0] = 0;
+    } else {
+      // SEQ[0] and SEQ[1] play back to back LOOP times.  Each chunk goes
+      // into the half buffer of the sequence that just ended while the
+      // other one is playing.  An odd number of chunks is padded with a
+      // sequence holding only the end values.
+      static uint16_t seqEnd[2] = { 0 | (0x8000), 0 | (0x8000) }; // in RAM for EasyDMA
+      uint16_t* half[2] = { pixels_pattern, pixels_pattern + chunkBytes*8 + 2 };
+      uint32_t  chunks  = (numLEDs + chunkPixels - 1) / chunkPixels;
+      uint32_t  seqs    = chunks + (chunks & 1);
+
+      // A thread switch while the next chunk is encoded would let the
+      // PWM replay the stale half buffer.
+      SINGLE_THREADED_BLOCK() {
+        for(uint32_t k=0; k<seqs; k++) {
+          uint8_t b = k & 1;
+          if ( k >= 2 ) {
+            while(!dev->EVENTS_SEQEND[b]);
+            dev->EVENTS_SEQEND[b] = 0;
+          }
+          if ( k < chunks ) {
+            uint32_t first = k*chunkPixels;
+            uint32_t len   = numLEDs - first;
+            if ( len > chunkPixels ) len = chunkPixels;
+            encodePixels(encodePwm, 8*sizeof(uint16_t), (uint8_t *)half[b], first, len);
+            uint32_t cnt   = len*NEO_PIXEL_BYTES(NEO_TYPE)*8;
+            if ( k == chunks-1 ) { // Only the last chunk ends with the end values
+              half[b][cnt++] = 0 | (0x8000); // Seq end
+              half[b][cnt++] = 0 | (0x8000); // Seq end
+            }
+            dev->SEQ[b].PTR = (uint32_t)(uintptr_t)(half[b]) << PWM_SEQ_PTR_PTR_Pos;
+            dev->SEQ[b].CNT = cnt << PWM_SEQ_CNT_CNT_Pos;
+          } else {
+            dev->SEQ[b].PTR = (uint32_t)(uintptr_t)(seqEnd) << PWM_SEQ_PTR_PTR_Pos;
+            dev->SEQ[b].CNT = 2 << PWM_SEQ_CNT_CNT_Pos;
+          }
+          if ( k == 1 ) {
+            dev->LOOP = ((seqs/2) << PWM_LOOP_CNT_Pos);
+            dev->EVENTS_SEQEND[0]  = 0;
+            dev->EVENTS_SEQEND[1]  = 0;
+            dev->EVENTS_LOOPSDONE  = 0;
+            dev->TASKS_SEQSTART[0] = 1;
+          }
+        }
+      }
+
+      while(!dev->EVENTS_LOOPSDONE)
+      {
+        #ifdef ARDUINO_FEATHER52
+        yield();
+        #endif
+      }
+      dev->EVENTS_LOOPSDONE = 0;
+      dev->EVENTS_SEQEND[0] = 0;
+      dev->EVENTS_SEQEND[1] = 0;
 
-    // We need to disable the device and disconnect
-    // all the outputs before leave or the device will not
-    // be selected on the next call.
-    // TODO: Check if disabling the device causes performance issues.
-    pwm->ENABLE = 0;
+      // Back to single sequence playback for short frames
+      dev->LOOP = (PWM_LOOP_CNT_Disabled << PWM_LOOP_CNT_Pos);
+    }
 
-    pwm->PSEL.OUT[0] = 0xFFFFFFFFUL;
+    // Stop the PWM counter but keep the device enabled and the pin
+    // connected, so it stays claimed for the next frame.  While stopped
+    // the pin idles at the GPIO level set up in begin() (LOW).
+    dev->EVENTS_STOPPED = 0;
+    dev->TASKS_STOP = 1;
+    while(!dev->EVENTS_STOPPED);
+    dev->EVENTS_STOPPED = 0;
 
+    if ( (uint8_t *)pixels_pattern != encodeBuf && (uint8_t *)pixels_pattern != slot ) {
     #ifdef ARDUINO_FEATHER52  // use thread-safe free
       rtos_free(pixels_pattern);
     #else
       free(pixels_pattern);
     #endif
+    }
   }// End of DMA implementation
   // ---------------------------------------------------------------------
-  else{
+  else
+#endif // NEO_NO_PWM
+  {
+#ifndef NEO_NO_DWT_FALLBACK
     // Fall back to DWT
+    // The pin can't be driven as GPIO while a PWM device holds it
+    releasePwm();
+
+    // Cycle counts for the strip's timing
+    NeoTiming t = getTiming();
+    uint32_t cyclesPerUs    = SystemCoreClock / 1000000UL;
+    uint32_t CYCLES_X00     = t.periodNs * cyclesPerUs / 1000UL;
+    uint32_t CYCLES_X00_T1H = t.t1hNs * cyclesPerUs / 1000UL;
+    uint32_t CYCLES_X00_T0H = t.t0hNs * cyclesPerUs / 1000UL;
+
+    // Palette and white lookups that don't fit between two bits are done
+    // for the whole frame before the critical section
+    uint8_t *frame = expandFrame(CYCLES_X00 - CYCLES_X00_T1H);
+
     #ifdef ARDUINO_FEATHER52
       // Bluefruit Feather 52 uses freeRTOS
       // Critical Section is used since it does not block SoftDevice execution
@@ -1138,47 +1610,45 @@ void Adafruit_NeoPixel::show(void) {
 
     uint32_t pinMask = 1UL << NRF_GPIO_PIN_MAP(PIN_MAP2[pin].gpio_port, PIN_MAP2[pin].gpio_pin);
 
-
-    uint32_t CYCLES_X00     = CYCLES_800;
-    uint32_t CYCLES_X00_T1H = CYCLES_800_T1H;
-    uint32_t CYCLES_X00_T0H = CYCLES_800_T0H;
-
-#ifdef NEO_KHZ400
-    if( !is800KHz )
-    {
-      CYCLES_X00     = CYCLES_400;
-      CYCLES_X00_T1H = CYCLES_400_T1H;
-      CYCLES_X00_T0H = CYCLES_400_T0H;
-    }
-#endif
-
     // Enable DWT in debug core
     CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
     DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
-    // Tries to re-send the frame if is interrupted by the SoftDevice.
+    uint32_t irqOffStart = DWT->CYCCNT;
+
+    // Tries to re-send the frame if is interrupted by the SoftDevice,
+    // within the limits set by setRetryPolicy().
+    uint32_t cycBudget = retryBudgetUs * (SystemCoreClock / 1000000UL);
+    uint32_t cycFrame  = 8 * wireBytes * CYCLES_X00;
+    uint32_t cycFirst  = DWT->CYCCNT;
+    uint8_t  retries   = 0;
+    // Pixels are looked up (palette, white) in the low time before them,
+    // unless the frame was expanded above
+    uint8_t  bpp = NEO_PIXEL_BYTES(NEO_TYPE), buf[NEO_CH_MAX * 2];
     while(1) {
-      uint8_t *p = pixels;
-
       uint32_t cycStart = DWT->CYCCNT;
       uint32_t cyc = 0;
 
-      for(uint16_t n=0; n<numBytes; n++) {
-        uint8_t pix = *p++;
+      for(uint32_t i=0; i<numLEDs; i++) {
+        const uint8_t *p = frame ? &frame[i * bpp] : wirePixel(i, buf);
 
-        for(uint8_t mask = 0x80; mask; mask >>= 1) {
-          while(DWT->CYCCNT - cyc < CYCLES_X00);
-          cyc  = DWT->CYCCNT;
+        for(uint8_t n=0; n<bpp; n++) {
+          uint8_t pix = *p++;
 
-          NRF_GPIO->OUTSET |= pinMask;
+          for(uint8_t mask = 0x80; mask; mask >>= 1) {
+            while(DWT->CYCCNT - cyc < CYCLES_X00);
+            cyc  = DWT->CYCCNT;
 
-          if(pix & mask) {
-            while(DWT->CYCCNT - cyc < CYCLES_X00_T1H);
-          } else {
-            while(DWT->CYCCNT - cyc < CYCLES_X00_T0H);
-          }
+            NRF_GPIO->OUTSET |= pinMask;
+
+            if(pix & mask) {
+              while(DWT->CYCCNT - cyc < CYCLES_X00_T1H);
+            } else {
+              while(DWT->CYCCNT - cyc < CYCLES_X00_T0H);
+            }
 
-          NRF_GPIO->OUTCLR |= pinMask;
+            NRF_GPIO->OUTCLR |= pinMask;
+          }
         }
       }
       while(DWT->CYCCNT - cyc < CYCLES_X00);
@@ -1186,177 +1656,715 @@ void Adafruit_NeoPixel::show(void) {
 
       // If total time longer than 25%, resend the whole data.
       // Since we are likely to be interrupted by SoftDevice
-      if ( (DWT->CYCCNT - cycStart) < ( 8*numBytes*((CYCLES_X00*5)/4) ) ) {
+      uint32_t now = DWT->CYCCNT;
+      uint8_t action = neoRetryAction(now - cycStart, cycFrame, now - cycFirst,
+                                      retries, retryMax, cycBudget);
+      if ( action == NEO_RETRY_DONE ) {
         break;
       }
 
+      // Out of retries or time: give up and leave the strip showing
+      // whatever the last attempt latched.
+      if ( action == NEO_RETRY_GIVE_UP ) {
+        giveUps++;
+        forceRefresh(); // Send it again next time
+        break;
+      }
+      retries++;
+
       // re-send need 300us delay
       delayMicroseconds(300);
     }
+    lastRetries = retries;
 
     // Enable interrupts again
     #ifdef ARDUINO_FEATHER52
       taskEXIT_CRITICAL();
     #elif defined(NRF52_DISABLE_INT)
+      irqBlackout(DWT->CYCCNT - irqOffStart);
       __enable_irq();
+    #else
+      (void)irqOffStart;
     #endif
+    if( frame != encodeBuf ) free(frame);
+#else
+    forceRefresh(); // No PWM device free, the frame wasn't sent
+#endif // NEO_NO_DWT_FALLBACK
   }
 // END of NRF52 implementation
 
 
 #endif
+  (void)dirtyFrom; // Only used by some backends
+  (void)dirtyTo;
   endTime = micros(); // Save EOD time for latch on next call
 }
 
-// Set pixel color from separate R,G,B components:
-void Adafruit_NeoPixel::setPixelColor(
-  uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
-  if(n < numLEDs) {
-    if(brightness) { // See notes in setBrightness()
-      r = (r * brightness) >> 8;
-      g = (g * brightness) >> 8;
-      b = (b * brightness) >> 8;
+#if HAL_PLATFORM_NRF52840 // Argon, Boron, Xenon, B SoM, B5 SoM, E SoM X, Tracker
+#ifndef NEO_NO_PWM
+// Compare values for the four bits of a nibble, MSB first, packed as two
+// little-endian 32-bit words.  Lets the encoder write a whole byte of
+// pattern with four word stores instead of eight test-and-branch steps.
+static uint32_t pwmNibblePattern[16][2];
+static uint16_t pwmPatternT0H, pwmPatternT1H; // Compare values in the table
+
+// Fill the nibble table for the given 0 and 1 bit compare values, unless
+// it already holds them
+static void setPwmPattern(uint16_t t0h, uint16_t t1h) {
+  if (t0h == pwmPatternT0H && t1h == pwmPatternT1H) return;
+  for (uint8_t n = 0; n < 16; n++) {
+    uint32_t v[4];
+    for (uint8_t k = 0; k < 4; k++) v[k] = (n & (8 >> k)) ? t1h : t0h;
+    pwmNibblePattern[n][0] = v[0] | (v[1] << 16);
+    pwmNibblePattern[n][1] = v[2] | (v[3] << 16);
+  }
+  pwmPatternT0H = t0h;
+  pwmPatternT1H = t1h;
+}
+
+// Expand 'bytes' pixel bytes into PWM compare values, 8 values (16 bytes)
+// per pixel byte, using the table set up by setPwmPattern().
+static void encodePwm(uint8_t* pattern, const uint8_t* in, uint32_t bytes) {
+  // Expand each pixel byte into 8 compare values, one nibble (two
+  // 32-bit words) at a time from the table.
+  uint32_t* out = (uint32_t*)pattern;
+  for(uint32_t n=0; n<bytes; n++) {
+    uint8_t pix = in[n];
+    const uint32_t* hi = pwmNibblePattern[pix >> 4];
+    const uint32_t* lo = pwmNibblePattern[pix & 0x0F];
+    *out++ = hi[0];
+    *out++ = hi[1];
+    *out++ = lo[0];
+    *out++ = lo[1];
+  }
+}
+#endif // NEO_NO_PWM
+
+// Find a free PWM device (not enabled and no connected pins), configure it
+// for the NeoPixel bitstream and keep it enabled on our pin so that show()
+// only has to load the sequence pointer and start it.
+void Adafruit_NeoPixel::claimPwm(void) {
+  if (pwm != NULL) return;
+#ifndef NEO_NO_PWM
+
+  NRF_PWM_Type* dev = NULL;
+  NRF_PWM_Type* PWM[3] = {NRF_PWM0, NRF_PWM1, NRF_PWM2};
+  for(int device = 0; device<3; device++) {
+    if( (PWM[device]->ENABLE == 0)                            &&
+        (PWM[device]->PSEL.OUT[0] & PWM_PSEL_OUT_CONNECT_Msk) &&
+        (PWM[device]->PSEL.OUT[1] & PWM_PSEL_OUT_CONNECT_Msk) &&
+        (PWM[device]->PSEL.OUT[2] & PWM_PSEL_OUT_CONNECT_Msk) &&
+        (PWM[device]->PSEL.OUT[3] & PWM_PSEL_OUT_CONNECT_Msk)
+    ) {
+      dev = PWM[device];
+      break;
     }
-    uint8_t *p = &pixels[n * 3];
-    switch(type) {
-      case WS2812B: // WS2812, WS2812B & WS2813 is GRB order.
-      case WS2812B_FAST:
-      case WS2812B2:
-      case WS2812B2_FAST: {
-          *p++ = g;
-          *p++ = r;
-          *p = b;
-        } break;
-      case TM1829: { // TM1829 is special RBG order
-          if(r == 255) r = 254; // 255 on RED channel causes display to be in a special mode.
-          *p++ = r;
-          *p++ = b;
-          *p = g;
-        } break;
-      case WS2811: // WS2811 is RGB order
-      case TM1803: // TM1803 is RGB order
-      default: {   // default is RGB order
-          *p++ = r;
-          *p++ = g;
-          *p = b;
-        } break;
+  }
+  if (dev == NULL) return; // show() falls back to DWT
+
+  // Set the wave mode to count UP
+  dev->MODE = (PWM_MODE_UPDOWN_Up << PWM_MODE_UPDOWN_Pos);
+
+  // Set the PWM to use the 16MHz clock
+  dev->PRESCALER = (PWM_PRESCALER_PRESCALER_DIV_1 << PWM_PRESCALER_PRESCALER_Pos);
+
+  // Disable loops, we want the sequence to repeat only once
+  dev->LOOP = (PWM_LOOP_CNT_Disabled << PWM_LOOP_CNT_Pos);
+
+  // On the "Common" setting the PWM uses the same pattern for the
+  // for supported sequences. The pattern is stored on half-word
+  // of 16bits
+  dev->DECODER = (PWM_DECODER_LOAD_Common << PWM_DECODER_LOAD_Pos) |
+                 (PWM_DECODER_MODE_RefreshCount << PWM_DECODER_MODE_Pos);
+
+  // The following settings are ignored with the current config.
+  dev->SEQ[0].REFRESH  = 0;
+  dev->SEQ[0].ENDDELAY = 0;
+
+  // PSEL must be configured before enabling PWM
+  dev->PSEL.OUT[0] = NRF_GPIO_PIN_MAP(PIN_MAP2[pin].gpio_port, PIN_MAP2[pin].gpio_pin);
+
+  // Enable the PWM
+  dev->ENABLE = 1;
+
+  pwm = dev;
+  timePwm();
+#endif // NEO_NO_PWM
+}
+
+// Set the claimed PWM device's bit period and the compare values of 0 and
+// 1 bits for the strip's timing, in steps of the 16MHz PWM clock (WS2812B:
+// CTOPVAL, MAGIC_T0H and MAGIC_T1H).  Done when the device is claimed and
+// when the timing changes, not per frame.
+void Adafruit_NeoPixel::timePwm(void) {
+#ifndef NEO_NO_PWM
+  if (pwm == NULL) return;
+  NeoTiming t = getTiming();
+  uint16_t ctop = (t.periodNs * 16UL + 500) / 1000;
+  ((NRF_PWM_Type*)pwm)->COUNTERTOP = (ctop << PWM_COUNTERTOP_COUNTERTOP_Pos);
+  pwmT0H = ((t.t0hNs * 16UL + 500) / 1000) | (0x8000);
+  pwmT1H = ((t.t1hNs * 16UL + 500) / 1000) | (0x8000);
+#endif // NEO_NO_PWM
+}
+
+// Limit how often the DWT fallback re-sends a frame that was interrupted
+// by the SoftDevice.  maxRetries of NEO_RETRY_UNLIMITED and budgetUs of 0
+// (the defaults) mean no limit.
+void Adafruit_NeoPixel::setRetryPolicy(uint8_t maxRetries, uint32_t budgetUs) {
+  retryMax = maxRetries;
+  retryBudgetUs = budgetUs;
+}
+
+// Number of re-sends the last show() needed on the DWT fallback
+uint8_t Adafruit_NeoPixel::getRetryCount(void) const {
+  return lastRetries;
+}
+
+// Number of frames abandoned because the retry policy ran out
+uint32_t Adafruit_NeoPixel::getGiveUpCount(void) const {
+  return giveUps;
+}
+
+// Disable the claimed PWM device and disconnect its output so it can be
+// selected again (by this or any other strip).
+void Adafruit_NeoPixel::releasePwm(void) {
+  if (pwm == NULL) return;
+
+  NRF_PWM_Type* dev = (NRF_PWM_Type*)pwm;
+  dev->ENABLE = 0;
+  dev->PSEL.OUT[0] = 0xFFFFFFFFUL;
+  pwm = NULL;
+}
+#endif // HAL_PLATFORM_NRF52840
+
+// Record how long show() kept interrupts disabled.  Called with interrupts
+// still disabled.  SysTick keeps one tick pending while masked, so only the
+// time beyond one tick period is actually lost from millis().  The lost
+// time is only reported: the tick handler belongs to the system firmware
+// and must not be run from thread code.
+void Adafruit_NeoPixel::irqBlackout(uint32_t cycles) {
+  uint32_t us = cycles / (SystemCoreClock / 1000000UL);
+  blackoutUs = us;
+#if (PLATFORM_ID == 0) || (PLATFORM_ID == 6) || (PLATFORM_ID == 8) || (PLATFORM_ID == 10) || (PLATFORM_ID == 88) // Core (0), Photon (6), P1 (8), Electron (10) or Redbear Duo (88)
+  if(us > 1000UL) driftUs += us - 1000UL;
+#endif
+  // nRF52 keeps system time in the RTC, which is not affected by masking
+  // interrupts, so only the blackout itself is reported there.
+}
+
+#ifndef NEO_NO_CLOCKED
+// Wire bytes unchanged, for encodePixels()
+static void copyWire(uint8_t* out, const uint8_t* in, uint32_t bytes) {
+  memcpy(out, in, bytes);
+}
+
+// Send the frame to clocked chips (APA102, SK9822) by SPI DMA: a start
+// frame of 32 zero bits, 32 bits per pixel, then 32 more zero bits (SK9822
+// latch) and one more bit per two pixels, since each chip delays the
+// clock it passes on by half a cycle.  Pixels go straight from the pixel
+// buffer, except palette colors and read-only attached buffers (which may
+// be in flash, where nRF52 EasyDMA can't read) go through a stack copy.
+void Adafruit_NeoPixel::showClocked(void) {
+  static uint8_t zeros[16]; // in RAM for DMA
+  if (!begun) return;
+
+  uint8_t bpp = NEO_PIXEL_BYTES(NEO_TYPE);
+  uint32_t wireBytes = numLEDs * bpp;
+  uint32_t endBytes = 4 + (numLEDs + 15) / 16;
+
+  spi_->beginTransaction();
+  spi_->transfer(zeros, NULL, 4, NULL);
+  if (!paletteBits && !constPixels) {
+    for (uint32_t done = 0; done < wireBytes; ) {
+      uint32_t len = wireBytes - done;
+      if (len > 0xFFFC) len = 0xFFFC; // DMA transfers are limited to 64K
+      spi_->transfer(pixels + done, NULL, len, NULL);
+      done += len;
+    }
+  } else {
+    // Copied (and palette colors looked up) into a stack buffer a chunk
+    // at a time
+    uint8_t chunk[64 * 4];
+    for (uint32_t n = 0, len; n < numLEDs; n += len) {
+      len = numLEDs - n;
+      if (len > sizeof(chunk) / bpp) len = sizeof(chunk) / bpp;
+      encodePixels(copyWire, 1, chunk, n, len);
+      spi_->transfer(chunk, NULL, len * bpp, NULL);
     }
   }
+  for (uint32_t len; endBytes; endBytes -= len) {
+    len = (endBytes > sizeof(zeros)) ? sizeof(zeros) : endBytes;
+    spi_->transfer(zeros, NULL, len, NULL);
+  }
+  spi_->endTransaction();
+}
+#endif // NEO_NO_CLOCKED
+
+// Clear 'bytes' of color data (pixels or palette entries) to off.  The
+// brightness byte of clocked chips is set to full so that colors show up.
+void Adafruit_NeoPixel::blankColors(uint8_t *p, uint32_t bytes) const {
+  const NeoPixelType &t = neoPixelType(NEO_TYPE);
+  memset(p, 0, bytes);
+  for (uint8_t i = 0; i < t.channels; i++) {
+    if (t.order[i] != NEO_CH_L) continue;
+    for (uint32_t k = i; k < bytes; k += t.channels) p[k] = 0xFF;
+  }
+}
+
+// Set pixel color from separate R,G,B components:
+void Adafruit_NeoPixel::setPixelColor(
+  uint32_t n, uint8_t r, uint8_t g, uint8_t b) {
+  if(n < numLEDs && !constPixels && !paletteBits) {
+    uint8_t v[NEO_CH_MAX] = { r, g, b };
+    storeChannels(&pixels[n * NEO_PIXEL_BYTES(NEO_TYPE)], v, NEO_CH_B + 1);
+    markDirty(n, 1);
+  }
 }
 
 // Set pixel color from separate R,G,B,W components:
 void Adafruit_NeoPixel::setPixelColor(
-  uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
-  if(n < numLEDs) {
-    if(brightness) { // See notes in setBrightness()
-      r = (r * brightness) >> 8;
-      g = (g * brightness) >> 8;
-      b = (b * brightness) >> 8;
-      w = (w * brightness) >> 8;
-    }
-    uint8_t *p = &pixels[n * (type==SK6812RGBW?4:3)];
-    switch(type) {
-      case WS2812B: // WS2812, WS2812B & WS2813 is GRB order.
-      case WS2812B_FAST:
-      case WS2812B2:
-      case WS2812B2_FAST: {
-          *p++ = g;
-          *p++ = r;
-          *p = b;
-        } break;
-      case TM1829: { // TM1829 is special RBG order
-          if(r == 255) r = 254; // 255 on RED channel causes display to be in a special mode.
-          *p++ = r;
-          *p++ = b;
-          *p = g;
-        } break;
-      case SK6812RGBW: { // SK6812RGBW is RGBW order
-          *p++ = r;
-          *p++ = g;
-          *p++ = b;
-          *p = w;
-        } break;
-      case WS2811: // WS2811 is RGB order
-      case TM1803: // TM1803 is RGB order
-      default: {   // default is RGB order
-          *p++ = r;
-          *p++ = g;
-          *p = b;
-        } break;
-    }
+  uint32_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+  if(n < numLEDs && !constPixels && !paletteBits) {
+    uint8_t v[NEO_CH_MAX] = { r, g, b, w };
+    storeChannels(&pixels[n * NEO_PIXEL_BYTES(NEO_TYPE)], v, NEO_CH_W + 1);
+    markDirty(n, 1);
+  }
+}
+
+// Set pixel color from separate R,G,B, warm white and cool white components
+// (RGBCW pixels such as WS2805):
+void Adafruit_NeoPixel::setPixelColor(
+  uint32_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w, uint8_t c) {
+  if(n < numLEDs && !constPixels && !paletteBits) {
+    uint8_t v[NEO_CH_MAX] = { r, g, b, w, c };
+    storeChannels(&pixels[n * NEO_PIXEL_BYTES(NEO_TYPE)], v, NEO_CH_C + 1);
+    markDirty(n, 1);
   }
 }
 
 // Set pixel color from 'packed' 32-bit RGB color:
 // If RGB+W color, order of bytes is WRGB in packed 32-bit form
-void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c) {
-  if(n < numLEDs) {
-    uint8_t
-      r = (uint8_t)(c >> 16),
-      g = (uint8_t)(c >>  8),
-      b = (uint8_t)c;
-    if(brightness) { // See notes in setBrightness()
-      r = (r * brightness) >> 8;
-      g = (g * brightness) >> 8;
-      b = (b * brightness) >> 8;
+void Adafruit_NeoPixel::setPixelColor(uint32_t n, uint32_t c) {
+  if(n < numLEDs && !constPixels && !paletteBits) {
+    uint8_t v[NEO_CH_MAX] = {
+      (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c, (uint8_t)(c >> 24) };
+    storeChannels(&pixels[n * NEO_PIXEL_BYTES(NEO_TYPE)], v, NEO_CH_W + 1);
+    markDirty(n, 1);
+  }
+}
+
+// Set a single color channel (NEO_CH_*) of pixel n, leaving the others
+void Adafruit_NeoPixel::setPixelChannel(uint32_t n, uint8_t ch, uint8_t v) {
+  if(n < numLEDs && !constPixels && !paletteBits && ch < NEO_CH_MAX) {
+    const NeoPixelType &t = neoPixelType(NEO_TYPE);
+    uint8_t *p = &pixels[n * NEO_PIXEL_BYTES(NEO_TYPE)];
+    if(ch == NEO_CH_L) v = 0xE0 | (v & 0x1F); // Brightness byte starts with 3 one bits
+    else if(brightness) v = (v * brightness) >> 8; // See notes in setBrightness()
+    if(NEO_TYPE == TM1829 && ch == NEO_CH_R && v == 255) v = 254; // See storeChannels()
+    for(uint8_t i = 0; i < t.channels; i++, p += t.depth) {
+      if(t.order[i] != ch) continue;
+      p[0] = v;
+      if(t.depth == 2) p[1] = v;
+    }
+    markDirty(n, 1);
+  }
+}
+
+// Enable/disable a 16-bit per channel render buffer.  It is set with
+// setPixelColor16() and reduced to 8 bits with dithering (see setDither())
+// every time show() runs, so slow fades and low brightness colors don't
+// band.  The 8-bit setters have no visible effect while it is enabled.
+// Not available in palette mode, with a read-only buffer or on native 16-bit
+// chips (WS2816, UCS8903), where setPixelColor16() writes the strip directly.
+// Returns false if memory isn't available.
+bool Adafruit_NeoPixel::set16BitBuffer(bool enable) {
+  forceRefresh();
+  if (!enable) {
+    if (pixels16) free(pixels16);
+    if (ditherErr) free(ditherErr);
+    pixels16 = NULL;
+    ditherErr = NULL;
+    return true;
+  }
+  if (pixels16) return true;
+  if (paletteBits || constPixels || NEO_IS_16BIT(NEO_TYPE) ||
+      neoPixelType(NEO_TYPE).timing == NEO_TIMING_CLOCKED) return false;
+  return resize16(0);
+}
+
+// (Re)size the 16-bit buffer and dither state from oldBytes to numBytes
+// channels, keeping existing values.  New channels start from the 8-bit
+// buffer's value.
+bool Adafruit_NeoPixel::resize16(uint32_t oldBytes) {
+  uint32_t size = numBytes ? numBytes : 1;
+  uint16_t *p16 = (uint16_t *)realloc(pixels16, size * sizeof(uint16_t));
+  if (p16 == NULL) return false;
+  pixels16 = p16;
+  uint8_t *err = (uint8_t *)realloc(ditherErr, size);
+  if (err == NULL) return false;
+  ditherErr = err;
+  for (uint32_t i = oldBytes; i < numBytes; i++) {
+    pixels16[i] = pixels[i] * 257;
+    ditherErr[i] = 0;
+  }
+  return true;
+}
+
+// Set pixel color in the 16-bit render buffer (see set16BitBuffer()).  On
+// native 16-bit chips the color goes straight to the strip, MSB first.
+void Adafruit_NeoPixel::setPixelColor16(
+  uint32_t n, uint16_t r, uint16_t g, uint16_t b, uint16_t w) {
+  if(n < numLEDs && NEO_IS_16BIT(NEO_TYPE) && !constPixels && !paletteBits) {
+    const NeoPixelType &t = neoPixelType(NEO_TYPE);
+    uint32_t scale = brightness ? brightness : 256;
+    uint16_t c[NEO_CH_MAX] = { r, g, b, w };
+    uint8_t *p = &pixels[n * NEO_PIXEL_BYTES(NEO_TYPE)];
+    for(uint8_t i = 0; i < t.channels; i++) {
+      uint16_t v = (c[t.order[i]] * scale) >> 8;
+      *p++ = v >> 8;
+      *p++ = v;
+    }
+    markDirty(n, 1);
+  } else if(n < numLEDs && pixels16) {
+    const NeoPixelType &t = neoPixelType(NEO_TYPE);
+    uint16_t v[NEO_CH_MAX] = { r, g, b, w };
+    if(NEO_TYPE == TM1829 && r > 0xFE00) v[NEO_CH_R] = 0xFE00; // must never dither up to 255 on RED (special mode)
+    uint16_t *p = &pixels16[n * NEO_PIXEL_BYTES(NEO_TYPE)];
+    for(uint8_t i = 0; i < t.channels; i++) {
+      *p++ = v[t.order[i]];
     }
-    uint8_t *p = &pixels[n * (type==SK6812RGBW?4:3)];
-    switch(type) {
-      case WS2812B: // WS2812, WS2812B & WS2813 is GRB order.
-      case WS2812B_FAST:
-      case WS2812B2:
-      case WS2812B2_FAST: {
-          *p++ = g;
-          *p++ = r;
-          *p = b;
-        } break;
-      case TM1829: { // TM1829 is special RBG order
-          if(r == 255) r = 254; // 255 on RED channel causes display to be in a special mode.
-          *p++ = r;
-          *p++ = b;
-          *p = g;
-        } break;
-      case SK6812RGBW: { // SK6812RGBW is RGBW order
-          uint8_t w = (uint8_t)(c >> 24);
-          *p++ = r;
-          *p++ = g;
-          *p++ = b;
-          *p = brightness ? ((w * brightness) >> 8) : w;
-        } break;
-      case WS2811: // WS2811 is RGB order
-      case TM1803: // TM1803 is RGB order
-      default: {   // default is RGB order
-          *p++ = r;
-          *p++ = g;
-          *p = b;
-        } break;
+    markDirty(n, 1);
+  }
+}
+
+// Select how the 16-bit render buffer is reduced to 8 bits:
+// NEO_DITHER_NONE, NEO_DITHER_ORDERED or NEO_DITHER_DIFFUSION.
+void Adafruit_NeoPixel::setDither(uint8_t mode) {
+  ditherMode = mode;
+  forceRefresh();
+}
+
+// Reduce the 16-bit render buffer into 'pixels', applying brightness.
+// Everything stays in 32-bit integer math; each channel costs a multiply,
+// an add and a shift.
+void Adafruit_NeoPixel::reduce16(void) {
+  const uint16_t *in  = pixels16;
+  uint8_t        *out = pixels;
+  uint32_t        len = numBytes;
+  uint32_t      scale = brightness ? brightness : 256; // See notes in setBrightness()
+
+  switch(ditherMode) {
+    case NEO_DITHER_DIFFUSION: {
+        // The part of each channel that didn't fit in 8 bits is carried to
+        // the next frame, so over time the average output is exact.
+        uint8_t *err = ditherErr;
+        for(uint32_t i=0; i<len; i++) {
+          uint32_t v = ((in[i] * scale) >> 8) + err[i];
+          if(v > 0xFFFF) v = 0xFFFF;
+          out[i] = v >> 8;
+          err[i] = v;
+        }
+      } break;
+    case NEO_DITHER_ORDERED: {
+        // 8-step ordered threshold that moves along the strip and changes
+        // every frame
+        static const uint8_t bayer8[8] = { 16, 144, 80, 208, 48, 176, 112, 240 };
+        uint8_t bpp   = NEO_PIXEL_BYTES(NEO_TYPE);
+        uint8_t phase = ditherFrame++;
+        for(uint32_t i=0, c=0; i<len; i++) {
+          uint32_t v = ((in[i] * scale) >> 8) + bayer8[phase & 7];
+          if(v > 0xFFFF) v = 0xFFFF;
+          out[i] = v >> 8;
+          if(++c == bpp) { c = 0; phase++; }
+        }
+      } break;
+    case NEO_DITHER_NONE:
+    default: {
+        for(uint32_t i=0; i<len; i++) {
+          uint32_t v = ((in[i] * scale) >> 8) + 0x80;
+          if(v > 0xFFFF) v = 0xFFFF;
+          out[i] = v >> 8;
+        }
+      } break;
+  }
+}
+
+// Store brightness-scaled channel values v[NEO_CH_*] at p in the strip's
+// wire order.  Only channels below 'used' are written; the others keep
+// their value.  'v' is scaled in place.
+void Adafruit_NeoPixel::storeChannels(uint8_t *p, uint8_t *v, uint8_t used) {
+  const NeoPixelType &t = neoPixelType(NEO_TYPE);
+  if(brightness) { // See notes in setBrightness()
+    for(uint8_t ch = 0; ch < used; ch++) v[ch] = (v[ch] * brightness) >> 8;
+  }
+  if(NEO_TYPE == TM1829 && v[NEO_CH_R] == 255) v[NEO_CH_R] = 254; // 255 on RED channel causes display to be in a special mode.
+  for(uint8_t i = 0; i < t.channels; i++, p += t.depth) {
+    uint8_t ch = t.order[i];
+    if(ch >= used) continue;
+    p[0] = v[ch];
+    if(t.depth == 2) p[1] = v[ch]; // 8-bit value in both bytes of 16-bit channels
+  }
+}
+
+// Switch between direct colors (bits = 0) and palette mode with 8-bit or
+// 4-bit palette indices per pixel.  In palette mode each pixel costs one
+// byte (or half a byte) instead of 3-4 and is expanded to its palette
+// color when the frame is sent, so changing a palette entry recolors all
+// pixels using it.  The strip keeps its length, but all pixels are reset
+// (to index 0 / off).  Returns false if memory isn't available.
+bool Adafruit_NeoPixel::setPaletteMode(uint8_t bits) {
+  if (bits != 0 && bits != 4 && bits != 8) return false;
+  if (bits == paletteBits) return true;
+  if (pixels16) return false; // Not together with the 16-bit render buffer
+
+  uint8_t *newPalette = NULL;
+  if (bits) {
+    uint32_t size = (1UL << bits) * NEO_PIXEL_BYTES(NEO_TYPE);
+    if ((newPalette = (uint8_t *)realloc(palette, size)) == NULL) return false;
+    blankColors(newPalette, size);
+  } else if (palette) {
+    free(palette);
+  }
+
+  uint32_t n = numLEDs;
+  palette = newPalette;
+  paletteBits = bits;
+  numLEDs = numBytes = 0;
+  updateLength(n); // Re-lays out and clears the pixel storage
+  return numLEDs == n;
+}
+
+// Set palette entry 'index' from a packed 32-bit (W)RGB color
+void Adafruit_NeoPixel::setPaletteColor(uint8_t index, uint32_t c) {
+  if(paletteBits && index < (1UL << paletteBits)) {
+    uint8_t v[NEO_CH_MAX] = {
+      (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c, (uint8_t)(c >> 24) };
+    storeChannels(&palette[index * NEO_PIXEL_BYTES(NEO_TYPE)], v, NEO_CH_C + 1);
+    forceRefresh(); // Recolors every pixel using the entry
+  }
+}
+
+// Set the palette index of pixel n (palette mode only)
+void Adafruit_NeoPixel::setPixelIndex(uint32_t n, uint8_t index) {
+  if(n < numLEDs && !constPixels) {
+    if(paletteBits == 8) {
+      pixels[n] = index;
+    } else if(paletteBits == 4) { // Even pixels in the high nibble
+      uint8_t *p = &pixels[n >> 1];
+      *p = (n & 1) ? ((*p & 0xF0) | (index & 0x0F)) : ((*p & 0x0F) | (index << 4));
     }
+    markDirty(n, 1);
   }
 }
 
-void Adafruit_NeoPixel::setColor(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue) {
+// Query the palette index of pixel n (0 if not in palette mode)
+uint8_t Adafruit_NeoPixel::getPixelIndex(uint32_t n) const {
+  if(n >= numLEDs) return 0;
+  if(paletteBits == 8) return pixels[n];
+  if(paletteBits == 4) return (pixels[n >> 1] >> ((n & 1) ? 0 : 4)) & 0x0F;
+  return 0;
+}
+
+// Write 'count' pixels starting at 'first' in wire order, looking up their
+// colors in the palette.
+void Adafruit_NeoPixel::expandPalette(uint8_t *out, uint32_t first, uint32_t count) const {
+  uint8_t bpp = NEO_PIXEL_BYTES(NEO_TYPE);
+  for(uint32_t n = first; n < first + count; n++) {
+    const uint8_t *c = &palette[getPixelIndex(n) * bpp];
+    for(uint8_t k = 0; k < bpp; k++) *out++ = c[k];
+  }
+}
+
+// y / 255 as a multiply-shift, exact for y < 65535
+static inline uint32_t div255(uint32_t y) {
+  return (y + 1 + (y >> 8)) >> 8;
+}
+
+// Move the part of each pixel's color that the white LED can produce from
+// R,G,B to W, for 'count' pixels of wire data in place.  The white LED's
+// color and the channel positions are set up by setWhiteExtraction().
+void Adafruit_NeoPixel::extractWhite(uint8_t *wire, uint32_t count) const {
+  uint8_t
+    bpp = NEO_PIXEL_BYTES(NEO_TYPE),
+   *end = wire + count * bpp,
+    rPos = whitePos[0], gPos = whitePos[1], bPos = whitePos[2], wPos = whitePos[3],
+    wr = whiteColor >> 16, wg = whiteColor >> 8, wb = whiteColor;
+  uint16_t ir = whiteMul[0], ig = whiteMul[1], ib = whiteMul[2];
+
+  for(; wire < end; wire += bpp) {
+    uint32_t w = (wire[rPos] * ir) >> 8, x;
+    if((x = (wire[gPos] * ig) >> 8) < w) w = x;
+    if((x = (wire[bPos] * ib) >> 8) < w) w = x;
+    if(!w) continue;
+    if(w > 255) w = 255;
+    // w * white color never exceeds a channel, so these can't wrap
+    wire[rPos] -= div255(w * wr + 127);
+    wire[gPos] -= div255(w * wg + 127);
+    wire[bPos] -= div255(w * wb + 127);
+    x = wire[wPos] + w;
+    wire[wPos] = (x > 255) ? 255 : x;
+  }
+}
+
+// Run 'count' pixels starting at 'first' through a backend's 'encode'
+// function, which writes 'expansion' output bytes per wire byte.  Palette
+// indices are expanded and white is extracted through a small stack
+// buffer on the way.
+void Adafruit_NeoPixel::encodePixels(void (*encode)(uint8_t*, const uint8_t*, uint32_t),
+    uint8_t expansion, uint8_t *out, uint32_t first, uint32_t count) const {
+  uint8_t bpp = NEO_PIXEL_BYTES(NEO_TYPE);
+  if(!paletteBits && !whiteColor) {
+    encode(out, &pixels[first * bpp], count * bpp);
+    return;
+  }
+  uint8_t wire[32 * 6];
+  while(count) {
+    uint32_t len = (count > 32) ? 32 : count;
+    if(paletteBits) expandPalette(wire, first, len);
+    else memcpy(wire, &pixels[first * bpp], len * bpp);
+    if(whiteColor) extractWhite(wire, len);
+    encode(out, wire, len * bpp);
+    out   += len * bpp * expansion;
+    first += len;
+    count -= len;
+  }
+}
+
+// Pixel n in wire order, for the bit-banged outputs: its bytes in
+// 'pixels' or the palette, or with white extraction a copy in 'buf'
+// (NEO_PIXEL_BYTES bytes).
+const uint8_t *Adafruit_NeoPixel::wirePixel(uint32_t n, uint8_t *buf) const {
+  uint8_t bpp = NEO_PIXEL_BYTES(NEO_TYPE);
+  const uint8_t *c = paletteBits ? &palette[getPixelIndex(n) * bpp] : &pixels[n * bpp];
+  if(!whiteColor) return c;
+  memcpy(buf, c, bpp);
+  extractWhite(buf, 1);
+  return buf;
+}
+
+// The whole frame in wire order for the bit-banged outputs, if looking up
+// its pixels one by one (palette, white extraction) would take longer than
+// 'lowCycles', the low time of a 1 bit.  Uses encodeBuf if it is large
+// enough, else the heap.  NULL if there is nothing to expand or no memory,
+// which leaves the lookups to wirePixel() between the bits.
+uint8_t *Adafruit_NeoPixel::expandFrame(uint32_t lowCycles) {
+  if(!paletteBits && !whiteColor) return NULL;
+  uint32_t cycles = NEO_GAP_CYCLES;
+  if(paletteBits) cycles += NEO_PALETTE_CYCLES;
+  if(whiteColor)  cycles += NEO_WHITE_CYCLES;
+  if(cycles <= lowCycles) return NULL;
+
+  uint32_t bytes = numLEDs * NEO_PIXEL_BYTES(NEO_TYPE);
+  uint8_t *frame = (encodeBuf && bytes <= encodeBytes) ? encodeBuf : (uint8_t *)malloc(bytes);
+  if(frame == NULL) return NULL;
+  if(paletteBits) expandPalette(frame, 0, numLEDs);
+  else memcpy(frame, pixels, bytes);
+  if(whiteColor) extractWhite(frame, numLEDs);
+  return frame;
+}
+
+// Let show() drive the white LED of RGBW pixels from the colors set with
+// R,G,B only: the part of each color the white LED can produce is moved to
+// W, so whites and pastels use it instead of mixing R,G and B.  'white' is
+// the color of the white LED as packed RGB, e.g. Color(255, 200, 150) for
+// warm white.  The pixel buffer itself is not changed.  Returns false for
+// pixel types without a white channel.
+bool Adafruit_NeoPixel::setWhiteExtraction(bool enable, uint32_t white) {
+  const NeoPixelType &t = neoPixelType(NEO_TYPE);
+  forceRefresh();
+  if(!enable) {
+    whiteColor = 0;
+    return true;
+  }
+  bool hasWhite = false;
+  for(uint8_t i = 0; i < t.channels; i++) hasWhite |= (t.order[i] == NEO_CH_W);
+  if(!hasWhite || t.depth != 1) return false;
+  // No white channel may be 0, which also keeps whiteColor non-zero
+  uint8_t wr = white >> 16, wg = white >> 8, wb = white;
+  if(!wr) wr = 1;
+  if(!wg) wg = 1;
+  if(!wb) wb = 1;
+  whiteColor = Color(wr, wg, wb);
+  // Worked out once here rather than per pixel in show()
+  for(uint8_t i = 0; i < t.channels; i++) {
+    if(t.order[i] <= NEO_CH_W) whitePos[t.order[i]] = i;
+  }
+  whiteMul[0] = (255U << 8) / wr;
+  whiteMul[1] = (255U << 8) / wg;
+  whiteMul[2] = (255U << 8) / wb;
+  return true;
+}
+
+// Default timing of each NEO_TIMING_* class, within the datasheet
+// tolerances of all chips using it
+static const NeoTiming neoTimings[] = {
+  { 350,  800, 1250, 0 }, // NEO_TIMING_800KHZ
+  { 300,  600, 1250, 0 }, // NEO_TIMING_SK6812
+  { 500, 1200, 2500, 0 }, // NEO_TIMING_400KHZ
+  { 680, 1360, 2040, 0 }, // NEO_TIMING_TM1803
+  { 300,  800, 1100, 0 }, // NEO_TIMING_TM1829
+  {   0,    0,    0, 0 }, // NEO_TIMING_CLOCKED
+};
+
+// Replace the pixel type's timing with a custom one, e.g. to run a batch
+// of LEDs with a shorter latch or faster bits.  Each platform converts it
+// to its own units: DWT cycles on the bit-banged paths, PWM compare values
+// on nRF52 and the SPI clock on P2 (which keeps T0H and T1H at 1/3 and 2/3
+// of the bit period).  Returns false for clocked chips or if the times
+// don't fit (T0H < T1H < bit period).
+bool Adafruit_NeoPixel::setTiming(const NeoTiming& t) {
+  if(neoPixelType(NEO_TYPE).timing == NEO_TIMING_CLOCKED) return false;
+  if(t.t0hNs == 0 || t.t0hNs >= t.t1hNs || t.t1hNs >= t.periodNs) return false;
+  profile = t;
+  customTiming = true;
+#if HAL_PLATFORM_NRF52840
+  timePwm();
+#endif
+  forceRefresh();
+  return true;
+}
+
+// Go back to the pixel type's own timing
+void Adafruit_NeoPixel::resetTiming(void) {
+  customTiming = false;
+#if HAL_PLATFORM_NRF52840
+  timePwm();
+#endif
+  forceRefresh();
+}
+
+// Timing in use: the one set with setTiming(), or the pixel type's
+// nominal timing and reset time
+NeoTiming Adafruit_NeoPixel::getTiming(void) const {
+  if(customTiming) return profile;
+  NeoTiming t = neoTimings[neoPixelType(NEO_TYPE).timing];
+  t.resetUs = neoPixelType(NEO_TYPE).resetUs;
+  return t;
+}
+
+void Adafruit_NeoPixel::setColor(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue) {
   return setPixelColor(aLedNumber, (uint8_t) aRed, (uint8_t) aGreen, (uint8_t) aBlue);
 }
 
-void Adafruit_NeoPixel::setColor(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite) {
+void Adafruit_NeoPixel::setColor(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite) {
   return setPixelColor(aLedNumber, (uint8_t) aRed, (uint8_t) aGreen, (uint8_t) aBlue, (uint8_t) aWhite);
 }
 
-void Adafruit_NeoPixel::setColorScaled(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aScaling) {
+void Adafruit_NeoPixel::setColorScaled(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aScaling) {
   // scale RGB with a common brightness parameter
   setColor(aLedNumber, (aRed*aScaling)>>8, (aGreen*aScaling)>>8, (aBlue*aScaling)>>8);
 }
 
-void Adafruit_NeoPixel::setColorScaled(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite, byte aScaling) {
+void Adafruit_NeoPixel::setColorScaled(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite, byte aScaling) {
   // scale RGB with a common brightness parameter
   setColor(aLedNumber, (aRed*aScaling)>>8, (aGreen*aScaling)>>8, (aBlue*aScaling)>>8, (aWhite*aScaling)>>8);
 }
 
-void Adafruit_NeoPixel::setColorDimmed(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aBrightness) {
+void Adafruit_NeoPixel::setColorDimmed(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aBrightness) {
   setColorScaled(aLedNumber, aRed, aGreen, aBlue, brightnessToPWM(aBrightness));
 }
 
-void Adafruit_NeoPixel::setColorDimmed(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite, byte aBrightness) {
+void Adafruit_NeoPixel::setColorDimmed(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite, byte aBrightness) {
   setColorScaled(aLedNumber, aRed, aGreen, aBlue, aWhite, brightnessToPWM(aBrightness));
 }
 
@@ -1365,6 +2373,284 @@ byte Adafruit_NeoPixel::brightnessToPWM(byte aBrightness) {
   return pwmLevels[aBrightness>>4];
 }
 
+// Gamma 2.6 curve, so that equal steps in value look like equal steps in
+// brightness
+static const uint8_t neoGammaTable[256] = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,
+    1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,
+    3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   5,   6,   6,   6,   6,   7,
+    7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  10,  11,  11,  11,  12,  12,
+   13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,  20,
+   20,  21,  21,  22,  22,  23,  24,  24,  25,  25,  26,  27,  27,  28,  29,  29,
+   30,  31,  31,  32,  33,  34,  34,  35,  36,  37,  38,  38,  39,  40,  41,  42,
+   42,  43,  44,  45,  46,  47,  48,  49,  50,  51,  52,  53,  54,  55,  56,  57,
+   58,  59,  60,  61,  62,  63,  64,  65,  66,  68,  69,  70,  71,  72,  73,  75,
+   76,  77,  78,  80,  81,  82,  84,  85,  86,  88,  89,  90,  92,  93,  94,  96,
+   97,  99, 100, 102, 103, 105, 106, 108, 109, 111, 112, 114, 115, 117, 119, 120,
+  122, 124, 125, 127, 129, 130, 132, 134, 136, 137, 139, 141, 143, 145, 146, 148,
+  150, 152, 154, 156, 158, 160, 162, 164, 166, 168, 170, 172, 174, 176, 178, 180,
+  182, 184, 186, 188, 191, 193, 195, 197, 199, 202, 204, 206, 209, 211, 213, 215,
+  218, 220, 223, 225, 227, 230, 232, 235, 237, 240, 242, 245, 247, 250, 252, 255
+};
+
+uint8_t Adafruit_NeoPixel::gamma8(uint8_t x) {
+  return neoGammaTable[x];
+}
+
+// Gamma correct each byte of a packed 32-bit (W)RGB color
+uint32_t Adafruit_NeoPixel::gamma32(uint32_t c) {
+  return (uint32_t)neoGammaTable[c >> 24] << 24 | (uint32_t)neoGammaTable[(c >> 16) & 0xFF] << 16 |
+         (uint32_t)neoGammaTable[(c >> 8) & 0xFF] << 8 | neoGammaTable[c & 0xFF];
+}
+
+// Level of a color wheel channel at 'h' with its peak at 'peak', both on
+// a circle of 1536 steps: full within a sixth (256 steps) of the peak,
+// ramping down over the next sixth.  The clamps compile to selects, so
+// there is no switch over the six sectors of the wheel.
+static inline uint32_t hueLevel(int32_t h, int32_t peak) {
+  int32_t d = h - peak;
+  d = (d < 0) ? -d : d;
+  d = (d > 768) ? 1536 - d : d; // Distance around the circle
+  int32_t x = 512 - d;
+  return (x < 0) ? 0 : ((x > 255) ? 255 : x);
+}
+
+// Hue (0-65535, red at 0, green at 65536/3, blue at 2*65536/3), saturation
+// and value to R,G,B in v[0..2]
+static inline void hsvToRgb(uint16_t hue, uint8_t sat, uint8_t val, bool gamma, uint8_t *v) {
+  int32_t  h  = ((uint32_t)hue * 1536UL) >> 16;
+  uint32_t s1 = sat + 1, s2 = 255 - sat, v1 = val + 1;
+  uint32_t c[3] = { hueLevel(h, 0), hueLevel(h, 512), hueLevel(h, 1024) };
+  for(uint8_t i = 0; i < 3; i++) {
+    uint8_t y = (((c[i] * s1 >> 8) + s2) * v1) >> 8;
+    v[i] = gamma ? neoGammaTable[y] : y;
+  }
+}
+
+// Packed 32-bit RGB color from hue, saturation and value, optionally gamma
+// corrected (see gamma32())
+uint32_t Adafruit_NeoPixel::ColorHSV(uint16_t hue, uint8_t sat, uint8_t val, bool gamma) {
+  uint8_t v[3];
+  hsvToRgb(hue, sat, val, gamma, v);
+  return Color(v[0], v[1], v[2]);
+}
+
+// Fill the strip with 'reps' cycles of the color wheel starting at
+// 'firstHue' (negative reps run the other way).  Colors are written
+// straight to the pixel buffer in wire order.  Not available in palette
+// mode.
+void Adafruit_NeoPixel::rainbow(uint16_t firstHue, int8_t reps, uint8_t sat, uint8_t val, bool gamma) {
+  if(constPixels || paletteBits || numLEDs == 0) return;
+  const NeoPixelType &t = neoPixelType(NEO_TYPE);
+  // Hue in the upper 16 bits, so it wraps around by itself
+  uint32_t hue  = (uint32_t)firstHue << 16;
+  uint32_t step = (uint32_t)((int64_t)reps * 0x100000000LL / (int64_t)numLEDs);
+  uint8_t  bpp  = NEO_PIXEL_BYTES(NEO_TYPE);
+  uint8_t *p    = pixels;
+
+  if(t.depth == 2 || NEO_TYPE == TM1829) { // Channel rules of storeChannels()
+    for(uint32_t n = 0; n < numLEDs; n++, p += bpp, hue += step) {
+      uint8_t v[NEO_CH_MAX] = { 0 }; // White off
+      hsvToRgb(hue >> 16, sat, val, gamma, v);
+      storeChannels(p, v, NEO_CH_W + 1);
+    }
+  } else {
+    // Byte offsets of R, G, B and of the white channels (turned off)
+    uint8_t off[3] = { 0 }, white[NEO_CH_MAX], whites = 0;
+    for(uint8_t i = 0; i < t.channels; i++) {
+      if(t.order[i] <= NEO_CH_B) off[t.order[i]] = i;
+      else if(t.order[i] != NEO_CH_L) white[whites++] = i;
+    }
+    for(uint32_t n = 0; n < numLEDs; n++, p += bpp, hue += step) {
+      uint8_t v[3];
+      hsvToRgb(hue >> 16, sat, val, gamma, v);
+      if(brightness) { // See notes in setBrightness()
+        for(uint8_t i = 0; i < 3; i++) v[i] = (v[i] * brightness) >> 8;
+      }
+      p[off[0]] = v[0];
+      p[off[1]] = v[1];
+      p[off[2]] = v[2];
+      for(uint8_t i = 0; i < whites; i++) p[white[i]] = 0;
+    }
+  }
+  forceRefresh();
+}
+
+// Permutation for the noise lattice hash (Ken Perlin's reference table)
+static const uint8_t neoNoisePerm[256] = {
+  151, 160, 137,  91,  90,  15, 131,  13, 201,  95,  96,  53, 194, 233,   7, 225,
+  140,  36, 103,  30,  69, 142,   8,  99,  37, 240,  21,  10,  23, 190,   6, 148,
+  247, 120, 234,  75,   0,  26, 197,  62,  94, 252, 219, 203, 117,  35,  11,  32,
+   57, 177,  33,  88, 237, 149,  56,  87, 174,  20, 125, 136, 171, 168,  68, 175,
+   74, 165,  71, 134, 139,  48,  27, 166,  77, 146, 158, 231,  83, 111, 229, 122,
+   60, 211, 133, 230, 220, 105,  92,  41,  55,  46, 245,  40, 244, 102, 143,  54,
+   65,  25,  63, 161,   1, 216,  80,  73, 209,  76, 132, 187, 208,  89,  18, 169,
+  200, 196, 135, 130, 116, 188, 159,  86, 164, 100, 109, 198, 173, 186,   3,  64,
+   52, 217, 226, 250, 124, 123,   5, 202,  38, 147, 118, 126, 255,  82,  85, 212,
+  207, 206,  59, 227,  47,  16,  58,  17, 182, 189,  28,  42, 223, 183, 170, 213,
+  119, 248, 152,   2,  44, 154, 163,  70, 221, 153, 101, 155, 167,  43, 172,   9,
+  129,  22,  39, 253,  19,  98, 108, 110,  79, 113, 224, 232, 178, 185, 112, 104,
+  218, 246,  97, 228, 251,  34, 242, 193, 238, 210, 144,  12, 191, 179, 162, 241,
+   81,  51, 145, 235, 249,  14, 239, 107,  49, 192, 214,  31, 181, 199, 106, 157,
+  184,  84, 204, 176, 115, 121,  50,  45, 127,   4, 150, 254, 138, 236, 205,  93,
+  222, 114,  67,  29,  24,  72, 243, 141, 128, 195,  78,  66, 215,  61, 156, 180
+};
+
+// Gradient of lattice corner 'hash' dotted with the offset x, y, z from
+// that corner (Perlin's improved noise, 12 edge directions)
+static inline int32_t noiseGrad(uint8_t hash, int32_t x, int32_t y, int32_t z) {
+  uint8_t h = hash & 15;
+  int32_t u = (h < 8) ? x : y;
+  int32_t v = (h < 4) ? y : ((h == 12 || h == 14) ? x : z);
+  return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+// 3t^2 - 2t^3 for t in 0..256
+static inline int32_t noiseEase(int32_t t) {
+  return (t * t * (768 - 2 * t)) >> 16;
+}
+
+static inline int32_t noiseLerp(int32_t a, int32_t b, int32_t t) {
+  return a + (((b - a) * t) >> 8);
+}
+
+// Gradient noise along x at a fixed y and z (a strip, or one matrix row),
+// in 24.8 fixed point (256 = one lattice cell).  The corner hashes only
+// change when x moves into the next cell, so they are looked up once per
+// cell rather than for every pixel.
+struct NoiseRow {
+  int32_t  fy, fz, v, w; // Offsets into the cell in y and z, and their eases
+  uint8_t  Y, Z;
+  uint16_t cell;         // Cell in x the hashes are for, 0x100 = none yet
+  uint8_t  h[8];         // Corner hashes: x, x+1 at (y, z), (y+1, z), (y, z+1), (y+1, z+1)
+};
+
+static void noiseRowInit(NoiseRow &r, uint32_t y, uint32_t z) {
+  r.Y = y >> 8;
+  r.Z = z >> 8;
+  r.fy = y & 0xFF;
+  r.fz = z & 0xFF;
+  r.v = noiseEase(r.fy);
+  r.w = noiseEase(r.fz);
+  r.cell = 0x100;
+}
+
+// Noise at x on the row, roughly -256..256.  Integer math only; wraps
+// every 256 cells.
+static int32_t noiseRowAt(NoiseRow &r, uint32_t x) {
+  const uint8_t *P = neoNoisePerm;
+  uint8_t X = x >> 8;
+  if(X != r.cell) {
+    uint8_t A  = P[X] + r.Y, B = P[(uint8_t)(X + 1)] + r.Y;
+    uint8_t AA = P[A] + r.Z, AB = P[(uint8_t)(A + 1)] + r.Z;
+    uint8_t BA = P[B] + r.Z, BB = P[(uint8_t)(B + 1)] + r.Z;
+    r.h[0] = P[AA];              r.h[1] = P[BA];
+    r.h[2] = P[AB];              r.h[3] = P[BB];
+    r.h[4] = P[(uint8_t)(AA + 1)]; r.h[5] = P[(uint8_t)(BA + 1)];
+    r.h[6] = P[(uint8_t)(AB + 1)]; r.h[7] = P[(uint8_t)(BB + 1)];
+    r.cell = X;
+  }
+  int32_t fx = x & 0xFF, gx = fx - 256, u = noiseEase(fx);
+  int32_t fy = r.fy, fz = r.fz, gy = fy - 256, gz = fz - 256;
+  int32_t lo = noiseLerp(noiseGrad(r.h[0], fx, fy, fz), noiseGrad(r.h[1], gx, fy, fz), u);
+  int32_t hi = noiseLerp(noiseGrad(r.h[4], fx, fy, gz), noiseGrad(r.h[5], gx, fy, gz), u);
+  if(r.v) { // The y+1 corners have no weight on a strip (y = 0)
+    lo = noiseLerp(lo, noiseLerp(noiseGrad(r.h[2], fx, gy, fz), noiseGrad(r.h[3], gx, gy, fz), u), r.v);
+    hi = noiseLerp(hi, noiseLerp(noiseGrad(r.h[6], fx, gy, gz), noiseGrad(r.h[7], gx, gy, gz), u), r.v);
+  }
+  return noiseLerp(lo, hi, r.w);
+}
+
+// Scale factor from summed octaves to 0..255 output (see noiseOctaves())
+static int32_t noiseGain(uint8_t octaves) {
+  int32_t amps = 0;
+  for(uint8_t o = 0; o < octaves; o++) amps += 256 >> o;
+  return (192L << 16) / amps;
+}
+
+// Set up rows[o] for each octave of a row at y, z (see noiseOctaves())
+static void noiseRowsInit(NoiseRow *rows, uint8_t octaves, uint32_t y, uint32_t z) {
+  for(uint8_t o = 0; o < octaves; o++) noiseRowInit(rows[o], y << o, z << o);
+}
+
+// Fractal noise in 0..255 at x on the rows: 'octaves' layers, each at
+// twice the frequency and half the amplitude of the one before
+static uint8_t noiseOctaves(NoiseRow *rows, uint8_t octaves, uint32_t x, int32_t gain) {
+  int32_t acc = 0;
+  for(uint8_t o = 0; o < octaves; o++) {
+    acc += noiseRowAt(rows[o], x << o) * (256 >> o);
+  }
+  int32_t v = 128 + (((acc >> 8) * gain) >> 16);
+  return (v < 0) ? 0 : ((v > 255) ? 255 : v);
+}
+
+// Smooth noise in 0..255 at x, y, z, with 256 units per noise cell
+uint8_t Adafruit_NeoPixel::noise8(uint32_t x, uint32_t y, uint32_t z) {
+  NoiseRow row;
+  noiseRowInit(row, y, z);
+  return noiseOctaves(&row, 1, x, noiseGain(1));
+}
+
+// Set pixel n for noise 'level': a palette index in palette mode,
+// otherwise the mix of two colors given as R,G,B,W
+void Adafruit_NeoPixel::storeNoise(uint32_t n, uint8_t level, const uint8_t *from, const uint8_t *to) {
+  if(paletteBits) {
+    setPixelIndex(n, level >> (8 - paletteBits));
+    return;
+  }
+  uint32_t t = level + (level >> 7); // 0..256
+  uint8_t v[NEO_CH_MAX];
+  for(uint8_t i = 0; i <= NEO_CH_W; i++) v[i] = (from[i] * (256 - t) + to[i] * t) >> 8;
+  storeChannels(&pixels[n * NEO_PIXEL_BYTES(NEO_TYPE)], v, NEO_CH_W + 1);
+}
+
+// Fill 'count' pixels from 'first' with smooth noise, for fire, water or
+// cloud effects.  'scale' is the noise step per pixel (256 = one noise
+// cell, so smaller is smoother), 'time' moves through the noise (add a
+// little every frame) and each extra octave adds finer detail.  The noise
+// mixes colors c0 and c1, or in palette mode picks the palette index.
+void Adafruit_NeoPixel::fillNoise(uint32_t first, uint32_t count, uint16_t scale, uint32_t time,
+                                  uint8_t octaves, uint32_t c0, uint32_t c1) {
+  if(constPixels || first >= numLEDs) return;
+  if(count > numLEDs - first) count = numLEDs - first;
+  if(octaves < 1) octaves = 1;
+  if(octaves > 8) octaves = 8;
+  int32_t gain = noiseGain(octaves);
+  uint8_t from[4] = { (uint8_t)(c0 >> 16), (uint8_t)(c0 >> 8), (uint8_t)c0, (uint8_t)(c0 >> 24) };
+  uint8_t to[4]   = { (uint8_t)(c1 >> 16), (uint8_t)(c1 >> 8), (uint8_t)c1, (uint8_t)(c1 >> 24) };
+  NoiseRow rows[8];
+  noiseRowsInit(rows, octaves, 0, time);
+  for(uint32_t n = first; n < first + count; n++) {
+    storeNoise(n, noiseOctaves(rows, octaves, n * scale, gain), from, to);
+  }
+  markDirty(first, count);
+}
+
+// Same for a width x height matrix laid out row by row, every other row
+// reversed if 'serpentine' (zigzag wiring)
+void Adafruit_NeoPixel::fillNoise2D(uint16_t width, uint16_t height, bool serpentine, uint16_t scale,
+                                    uint32_t time, uint8_t octaves, uint32_t c0, uint32_t c1) {
+  if(constPixels) return;
+  if(octaves < 1) octaves = 1;
+  if(octaves > 8) octaves = 8;
+  int32_t gain = noiseGain(octaves);
+  uint8_t from[4] = { (uint8_t)(c0 >> 16), (uint8_t)(c0 >> 8), (uint8_t)c0, (uint8_t)(c0 >> 24) };
+  uint8_t to[4]   = { (uint8_t)(c1 >> 16), (uint8_t)(c1 >> 8), (uint8_t)c1, (uint8_t)(c1 >> 24) };
+  NoiseRow rows[8];
+  for(uint32_t y = 0; y < height; y++) {
+    uint32_t row = y * width;
+    if(row >= numLEDs) break;
+    noiseRowsInit(rows, octaves, y * scale, time);
+    for(uint32_t x = 0; x < width; x++) {
+      uint32_t n = row + ((serpentine && (y & 1)) ? width - 1 - x : x);
+      if(n >= numLEDs) continue;
+      storeNoise(n, noiseOctaves(rows, octaves, x * scale, gain), from, to);
+    }
+  }
+  forceRefresh();
+}
+
 // Convert separate R,G,B into packed 32-bit RGB color.
 // Packed format is always RGB, regardless of LED strand color order.
 uint32_t Adafruit_NeoPixel::Color(uint8_t r, uint8_t g, uint8_t b) {
@@ -1378,62 +2664,289 @@ uint32_t Adafruit_NeoPixel::Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
 }
 
 // Query color from previously-set pixel (returns packed 32-bit RGB value)
-uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
+uint32_t Adafruit_NeoPixel::getPixelColor(uint32_t n) const {
   if(n >= numLEDs) {
     // Out of bounds, return no color.
     return 0;
   }
 
-  uint8_t *p = &pixels[n * (type==SK6812RGBW?4:3)];
-  uint32_t c;
-
-  switch(type) {
-    case WS2812B: // WS2812, WS2812B & WS2813 is GRB order.
-    case WS2812B_FAST:
-    case WS2812B2:
-    case WS2812B2_FAST: {
-        c = ((uint32_t)p[1] << 16) | ((uint32_t)p[0] <<  8) | (uint32_t)p[2];
-      } break;
-    case TM1829: { // TM1829 is special RBG order
-        c = ((uint32_t)p[0] << 16) | ((uint32_t)p[2] <<  8) | (uint32_t)p[1];
-      } break;
-    case SK6812RGBW: { // SK6812RGBW is RGBW order, but returns packed WRGB color
-        c = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] <<  8) | (uint32_t)p[3];
-      } break;
-    case WS2811: // WS2811 is RGB order
-    case TM1803: // TM1803 is RGB order
-    default: {   // default is RGB order
-        c = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] <<  8) | (uint32_t)p[2];
-      } break;
+  uint8_t *p;
+  if(paletteBits) { // Color comes from the pixel's palette entry
+    p = &palette[getPixelIndex(n) * NEO_PIXEL_BYTES(NEO_TYPE)];
+  } else {
+    p = &pixels[n * NEO_PIXEL_BYTES(NEO_TYPE)];
+  }
+  const NeoPixelType &t = neoPixelType(NEO_TYPE);
+  uint8_t v[NEO_CH_MAX] = { 0 };
+  for(uint8_t i = 0; i < t.channels; i++) {
+    v[t.order[i]] = p[i * t.depth]; // MSB of 16-bit channels
   }
 
   // Adjust this back up to the true color, as setting a pixel color will
   // scale it back down again.
   if(brightness) { // See notes in setBrightness()
-    //Cast the color to a byte array
-    uint8_t * c_ptr =reinterpret_cast<uint8_t*>(&c);
-    if (type == SK6812RGBW) {
-      c_ptr[3] = (c_ptr[3] << 8)/brightness;
-    }
-    c_ptr[0] = (c_ptr[0] << 8)/brightness;
-    c_ptr[1] = (c_ptr[1] << 8)/brightness;
-    c_ptr[2] = (c_ptr[2] << 8)/brightness;
+    for(uint8_t ch = 0; ch <= NEO_CH_W; ch++) v[ch] = (v[ch] << 8) / brightness;
   }
+  // Packed format is WRGB regardless of the strip's order
+  uint32_t c = ((uint32_t)v[NEO_CH_W] << 24) | ((uint32_t)v[NEO_CH_R] << 16) |
+               ((uint32_t)v[NEO_CH_G] <<  8) | (uint32_t)v[NEO_CH_B];
   return c; // Pixel # is out of bounds
 }
 
+// Query a single color channel (NEO_CH_*) of pixel n, 0 if the pixel or
+// the channel doesn't exist
+uint8_t Adafruit_NeoPixel::getPixelChannel(uint32_t n, uint8_t ch) const {
+  if(n >= numLEDs) return 0;
+
+  const NeoPixelType &t = neoPixelType(NEO_TYPE);
+  const uint8_t *p = paletteBits ? &palette[getPixelIndex(n) * NEO_PIXEL_BYTES(NEO_TYPE)]
+                                 : &pixels[n * NEO_PIXEL_BYTES(NEO_TYPE)];
+  for(uint8_t i = 0; i < t.channels; i++, p += t.depth) {
+    if(t.order[i] != ch) continue;
+    if(ch == NEO_CH_L) return *p & 0x1F;
+    return brightness ? (*p << 8) / brightness : *p; // See notes in setBrightness()
+  }
+  return 0;
+}
+
 uint8_t *Adafruit_NeoPixel::getPixels(void) const {
   return pixels;
 }
 
-uint16_t Adafruit_NeoPixel::numPixels(void) const {
+uint32_t Adafruit_NeoPixel::numPixels(void) const {
   return numLEDs;
 }
 
-uint16_t Adafruit_NeoPixel::getNumLeds(void) const {
+uint32_t Adafruit_NeoPixel::getNumLeds(void) const {
   return numPixels();
 }
 
+// Time in microseconds that interrupts were disabled by the last show()
+uint32_t Adafruit_NeoPixel::getBlackoutMicros(void) const {
+  return blackoutUs;
+}
+
+// Time in microseconds that millis() fell behind because of show(), summed
+// over all frames
+uint32_t Adafruit_NeoPixel::getDriftMicros(void) const {
+  return driftUs;
+}
+
+// Let show() skip frames in which nothing changed since the last one.
+// Setters, clear(), setBrightness() and the other calls that change the
+// frame are tracked; data written straight into getPixels() or an
+// attached buffer is not, so call forceRefresh() after doing that.
+void Adafruit_NeoPixel::setSkipUnchanged(bool enable) {
+  skipUnchanged = enable;
+  forceRefresh();
+}
+
+// Make the next show() send the whole frame
+void Adafruit_NeoPixel::forceRefresh(void) {
+  dirtyFirst = 0;
+  dirtyEnd = UINT32_MAX;
+}
+
+// Note that 'count' pixels starting at 'first' changed
+void Adafruit_NeoPixel::markDirty(uint32_t first, uint32_t count) {
+  if(first < dirtyFirst) dirtyFirst = first;
+  if(first + count > dirtyEnd) dirtyEnd = first + count;
+}
+
+// Pixels changed since the last show(): 'first' and 'count'.  Returns
+// false (count 0) if the frame is unchanged.
+bool Adafruit_NeoPixel::getDirtyRange(uint32_t& first, uint32_t& count) const {
+  uint32_t end = (dirtyEnd < numLEDs) ? dirtyEnd : numLEDs;
+  first = dirtyFirst;
+  count = (end > dirtyFirst) ? end - dirtyFirst : 0;
+  if(count == 0) first = 0;
+  return count != 0;
+}
+
+// Number of show() calls skipped because the frame was unchanged
+uint32_t Adafruit_NeoPixel::getSkippedFrames(void) const {
+  return skippedFrames;
+}
+
+#if (PLATFORM_ID == 32) || HAL_PLATFORM_NRF52840
+// Keep up to 'bytes' of recently encoded frames, so that animations that
+// repeat (e.g. a color wheel cycle) are only encoded the first time round.
+// Each entry holds one whole encoded frame plus the pixel data it was
+// encoded from; the least recently shown one is replaced when the pool is
+// full.  Frames too long for one DMA transfer are not cached.  0 turns the cache off.  Returns false if memory isn't available.
+bool Adafruit_NeoPixel::setFrameCache(uint32_t bytes) {
+  forceRefresh(); // The fixed encode buffer doesn't hold the last frame
+  if (cachePool) free(cachePool);
+  cachePool = NULL;
+  cacheBytes = cacheSlotBytes = cacheSlots = 0;
+  if (bytes == 0) return true;
+  if ((cachePool = (uint8_t *)malloc(bytes)) == NULL) return false;
+  cacheBytes = bytes;
+  return true;
+}
+
+// Frames found in / added to the cache by show()
+uint32_t Adafruit_NeoPixel::getCacheHits(void) const {
+  return cacheHits;
+}
+
+uint32_t Adafruit_NeoPixel::getCacheMisses(void) const {
+  return cacheMisses;
+}
+
+// FNV-1a, a 32-bit word at a time
+static uint32_t frameHash(uint32_t h, const uint8_t *p, uint32_t len) {
+  for (; len >= 4; len -= 4, p += 4) {
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    h = (h ^ w) * 16777619UL;
+  }
+  while (len--) h = (h ^ *p++) * 16777619UL;
+  return h;
+}
+
+// Cache entry for the current frame, 'encBytes' long once encoded.  Sets
+// 'hit' if it already holds the frame; otherwise the least recently used
+// entry is taken over for the frame to be encoded into.  NULL if the cache
+// is off or too small for one frame.
+//
+// Entry layout: hash, last use (0 = empty), key (settings the encoding
+// depends on, pixel data, palette), encoded frame; 4-byte aligned.
+uint8_t *Adafruit_NeoPixel::cacheFrame(uint32_t encBytes, bool& hit) {
+  hit = false;
+  if (cachePool == NULL) return NULL;
+
+  uint32_t cfg[3] = { whiteColor, 0, 0 };
+  if (customTiming) {
+    cfg[1] = (uint32_t)profile.t0hNs << 16 | profile.t1hNs;
+    cfg[2] = (uint32_t)profile.periodNs << 16 | profile.resetUs;
+  }
+  uint32_t palBytes = paletteBits ? (1UL << paletteBits) * NEO_PIXEL_BYTES(NEO_TYPE) : 0;
+  uint32_t keyBytes = (sizeof(cfg) + numBytes + palBytes + 3) & ~3UL;
+  uint32_t slotBytes = 2 * sizeof(uint32_t) + keyBytes + ((encBytes + 3) & ~3UL);
+  if (slotBytes != cacheSlotBytes) { // Frame size changed: start over
+    cacheSlotBytes = slotBytes;
+    cacheSlots = cacheBytes / slotBytes;
+    for (uint32_t i = 0; i < cacheSlots; i++) {
+      ((uint32_t *)(cachePool + i * slotBytes))[1] = 0;
+    }
+  }
+  if (cacheSlots == 0) return NULL;
+
+  uint32_t hash = frameHash(2166136261UL, (const uint8_t *)cfg, sizeof(cfg));
+  hash = frameHash(hash, pixels, numBytes);
+  hash = frameHash(hash, palette, palBytes);
+  cacheClock++;
+
+  uint32_t *victim = NULL;
+  for (uint32_t i = 0; i < cacheSlots; i++) {
+    uint32_t *e = (uint32_t *)(cachePool + i * slotBytes);
+    uint8_t *key = (uint8_t *)(e + 2);
+    if (e[1] && e[0] == hash &&
+        !memcmp(key, cfg, sizeof(cfg)) &&
+        !memcmp(key + sizeof(cfg), pixels, numBytes) &&
+        (palBytes == 0 || !memcmp(key + sizeof(cfg) + numBytes, palette, palBytes))) {
+      e[1] = cacheClock;
+      cacheHits++;
+      hit = true;
+      return key + keyBytes;
+    }
+    if (victim == NULL || e[1] < victim[1]) victim = e;
+  }
+
+  cacheMisses++;
+  uint8_t *key = (uint8_t *)(victim + 2);
+  victim[0] = hash;
+  victim[1] = cacheClock;
+  memcpy(key, cfg, sizeof(cfg));
+  memcpy(key + sizeof(cfg), pixels, numBytes);
+  if (palBytes) memcpy(key + sizeof(cfg) + numBytes, palette, palBytes);
+  return key + keyBytes;
+}
+#endif
+
+// Bulk kernels on 8-bit color data, 4 bytes per 32-bit word.  Even and
+// odd bytes of a word are worked on as two 16-bit lanes each, which have
+// room for an 8 x 9 bit product, so the results match the per-byte math
+// exactly.  Bytes set in 'keep' (a byte mask in little-endian word order,
+// e.g. 0x000000FF for the brightness byte of clocked chips) are left as
+// they are in the first source.
+//
+// Only addBytes() has a Cortex-M4/M33 DSP version (UQADD8).  The DSP
+// extension has no lane-wise multiply: SMUAD/SMLAD add their two 16-bit
+// products together, and UHADD8 only blends halfway.  One 32-bit MUL
+// (1 cycle) per pair of lanes is already the shortest way to scale and
+// blend.  UXTB16 would save only one shift-and-mask per word.
+static inline uint32_t loadWord(const uint8_t *p) {
+  uint32_t w;
+  memcpy(&w, p, sizeof(w));
+  return w;
+}
+
+static inline void storeWord(uint8_t *p, uint32_t w) {
+  memcpy(p, &w, sizeof(w));
+}
+
+// p = p * scale / 256, for scale 0..256
+static void scaleBytes(uint8_t *p, uint32_t len, uint32_t scale, uint32_t keep) {
+  for(; len >= 4; len -= 4, p += 4) {
+    uint32_t w    = loadWord(p);
+    uint32_t even = (((w & 0x00FF00FF) * scale) >> 8) & 0x00FF00FF;
+    uint32_t odd  = (((w >> 8) & 0x00FF00FF) * scale) & 0xFF00FF00;
+    storeWord(p, ((even | odd) & ~keep) | (w & keep));
+  }
+  for(uint32_t i = 0; i < len; i++, keep >>= 8) {
+    if(!(keep & 0xFF)) p[i] = (p[i] * scale) >> 8;
+  }
+}
+
+// out = (a * (256 - t) + b * t) / 256, for t 0..256
+static void blendBytes(uint8_t *out, const uint8_t *a, const uint8_t *b,
+                       uint32_t len, uint32_t t, uint32_t keep) {
+  uint32_t s = 256 - t;
+  for(; len >= 4; len -= 4, out += 4, a += 4, b += 4) {
+    uint32_t wa   = loadWord(a), wb = loadWord(b);
+    uint32_t even = (((wa & 0x00FF00FF) * s + (wb & 0x00FF00FF) * t) >> 8) & 0x00FF00FF;
+    uint32_t odd  = (((wa >> 8) & 0x00FF00FF) * s + ((wb >> 8) & 0x00FF00FF) * t) & 0xFF00FF00;
+    storeWord(out, ((even | odd) & ~keep) | (wa & keep));
+  }
+  for(uint32_t i = 0; i < len; i++, keep >>= 8) {
+    out[i] = (keep & 0xFF) ? a[i] : (a[i] * s + b[i] * t) >> 8;
+  }
+}
+
+// Same for big-endian 16-bit channels
+static void blendPairs(uint8_t *out, const uint8_t *a, const uint8_t *b,
+                       uint32_t len, uint32_t t) {
+  for(uint32_t i = 0; i < len; i += 2) {
+    uint32_t va = (uint32_t)a[i] << 8 | a[i + 1], vb = (uint32_t)b[i] << 8 | b[i + 1];
+    uint16_t v = (va * (256 - t) + vb * t) >> 8;
+    out[i]     = v >> 8;
+    out[i + 1] = v;
+  }
+}
+
+// out = min(a + b, 255)
+static void addBytes(uint8_t *out, const uint8_t *a, const uint8_t *b,
+                     uint32_t len, uint32_t keep) {
+  for(; len >= 4; len -= 4, out += 4, a += 4, b += 4) {
+    uint32_t wa = loadWord(a), wb = loadWord(b);
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP // Cortex-M4/M33
+    uint32_t sum = __UQADD8(wa, wb);
+#else
+    // Add the low 7 bits, then work out bit 7 and its carry out by hand
+    uint32_t low   = (wa & 0x7F7F7F7F) + (wb & 0x7F7F7F7F);
+    uint32_t carry = ((wa & wb) | ((wa | wb) & low)) & 0x80808080;
+    uint32_t sum   = (low ^ ((wa ^ wb) & 0x80808080)) | ((carry >> 7) * 0xFF);
+#endif
+    storeWord(out, (sum & ~keep) | (wa & keep));
+  }
+  for(uint32_t i = 0; i < len; i++, keep >>= 8) {
+    uint32_t v = a[i] + b[i];
+    out[i] = (keep & 0xFF) ? a[i] : (v > 255 ? 255 : v);
+  }
+}
+
 // Adjust output brightness; 0=darkest (off), 255=brightest.  This does
 // NOT immediately affect what's currently displayed on the LEDs.  The
 // next call to show() will refresh the LEDs at this level.  However,
@@ -1454,20 +2967,39 @@ void Adafruit_NeoPixel::setBrightness(uint8_t b) {
   // (color values are interpreted literally; no scaling), 1 = min
   // brightness (off), 255 = just below max brightness.
   uint8_t newBrightness = b + 1;
-  if(newBrightness != brightness) { // Compare against prior value
-    // Brightness has changed -- re-scale existing data in RAM
+  if(newBrightness != brightness && (!constPixels || paletteBits)) { // Compare against prior value
+    // Brightness has changed -- re-scale existing data in RAM.  In palette
+    // mode only the palette holds colors.
     uint8_t  c,
-            *ptr           = pixels,
+            *ptr           = paletteBits ? palette : pixels,
              oldBrightness = brightness - 1; // De-wrap old brightness value
     uint16_t scale;
     if(oldBrightness == 0) scale = 0; // Avoid /0
     else if(b == 255) scale = 65535 / oldBrightness;
     else scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
-    for(uint16_t i=0; i<numBytes; i++) {
-      c      = *ptr;
-      *ptr++ = (c * scale) >> 8;
+    uint32_t len = paletteBits ? ((1UL << paletteBits) * NEO_PIXEL_BYTES(NEO_TYPE)) : numBytes;
+    if(NEO_IS_16BIT(NEO_TYPE)) { // Big-endian 16-bit channels scale as pairs
+      for(uint32_t i=0; i<len; i+=2, ptr+=2) {
+        // Scaling back up can round past full scale
+        uint32_t v = (((uint32_t)ptr[0] << 8 | ptr[1]) * scale) >> 8;
+        if(v > 0xFFFF) v = 0xFFFF;
+        ptr[0] = v >> 8;
+        ptr[1] = v;
+      }
+    } else if(scale <= 256) { // Dimming (the usual case) a word at a time
+      scaleBytes(ptr, len, scale, colorKeepMask());
+    } else if(neoPixelType(NEO_TYPE).timing == NEO_TIMING_CLOCKED) {
+      for(uint32_t i=0; i<len; i++, ptr++) { // Skip the brightness byte (first)
+        if(i & 3) *ptr = (*ptr * scale) >> 8;
+      }
+    } else {
+      for(uint32_t i=0; i<len; i++) {
+        c      = *ptr;
+        *ptr++ = (c * scale) >> 8;
+      }
     }
     brightness = newBrightness;
+    forceRefresh();
   }
 }
 
@@ -1477,5 +3009,84 @@ uint8_t Adafruit_NeoPixel::getBrightness(void) const {
 }
 
 void Adafruit_NeoPixel::clear(void) {
-  memset(pixels, 0, numBytes);
+  if (constPixels) return;
+  if (paletteBits) memset(pixels, 0, numBytes);
+  else blankColors(pixels, numBytes);
+  forceRefresh();
+}
+
+// Byte mask of the bytes in each word of color data that are not colors
+// (the brightness byte of clocked chips), see scaleBytes()
+uint32_t Adafruit_NeoPixel::colorKeepMask(void) const {
+  return (neoPixelType(NEO_TYPE).timing == NEO_TIMING_CLOCKED) ? 0x000000FF : 0;
+}
+
+// Dim all pixels by amount/256 (of their current value), e.g. for fading
+// trails.  In palette mode the palette is dimmed.
+void Adafruit_NeoPixel::fadeToBlack(uint8_t amount) {
+  if(constPixels && !paletteBits) return;
+  uint8_t *p = paletteBits ? palette : pixels;
+  uint32_t len = paletteBits ? ((1UL << paletteBits) * NEO_PIXEL_BYTES(NEO_TYPE)) : numBytes;
+  uint32_t scale = 256 - amount;
+  if(NEO_IS_16BIT(NEO_TYPE)) {
+    for(uint32_t i = 0; i < len; i += 2, p += 2) {
+      uint16_t v = (((uint32_t)p[0] << 8 | p[1]) * scale) >> 8;
+      p[0] = v >> 8;
+      p[1] = v;
+    }
+  } else {
+    scaleBytes(p, len, scale, colorKeepMask());
+  }
+  forceRefresh();
+}
+
+// Mix the strip toward 'buf', a frame in the strip's wire order (like
+// getPixels()), by amount/255.  Not available in palette mode.
+void Adafruit_NeoPixel::blend(const uint8_t *buf, uint8_t amount) {
+  blend(pixels, buf, amount);
+}
+
+// Set the strip to 'from' mixed toward 'to' by amount/255 in one pass, for
+// crossfades between two rendered frames.  Both are in the strip's wire
+// order and may be the strip's own buffer.  Not available in palette mode.
+void Adafruit_NeoPixel::blend(const uint8_t *from, const uint8_t *to, uint8_t amount) {
+  if(constPixels || paletteBits || from == NULL || to == NULL) return;
+  uint32_t t = amount + (amount >> 7); // 0..256, so 255 gives 'to' exactly
+  if(NEO_IS_16BIT(NEO_TYPE)) blendPairs(pixels, from, to, numBytes, t);
+  else blendBytes(pixels, from, to, numBytes, t, colorKeepMask());
+  forceRefresh();
+}
+
+// Same with a separate amount for each pixel, one byte per pixel in
+// 'alpha' (e.g. for wipes or masked transitions)
+void Adafruit_NeoPixel::blendAlpha(const uint8_t *from, const uint8_t *to, const uint8_t *alpha) {
+  if(constPixels || paletteBits || from == NULL || to == NULL || alpha == NULL) return;
+  uint8_t  bpp  = NEO_PIXEL_BYTES(NEO_TYPE);
+  uint32_t keep = colorKeepMask();
+  bool     is16 = NEO_IS_16BIT(NEO_TYPE);
+  uint8_t *p    = pixels;
+  for(uint32_t n = 0; n < numLEDs; n++, p += bpp, from += bpp, to += bpp) {
+    uint32_t t = alpha[n] + (alpha[n] >> 7);
+    if(is16) blendPairs(p, from, to, bpp, t);
+    else blendBytes(p, from, to, bpp, t, keep); // A word per RGBW pixel
+  }
+  forceRefresh();
+}
+
+// Add the colors of 'buf' (in the strip's wire order) to the strip,
+// saturating at full brightness.  Not available in palette mode.
+void Adafruit_NeoPixel::addColors(const uint8_t *buf) {
+  if(constPixels || paletteBits || buf == NULL) return;
+  if(NEO_IS_16BIT(NEO_TYPE)) {
+    uint8_t *p = pixels;
+    for(uint32_t i = 0; i < numBytes; i += 2, p += 2, buf += 2) {
+      uint32_t v = ((uint32_t)p[0] << 8 | p[1]) + ((uint32_t)buf[0] << 8 | buf[1]);
+      if(v > 0xFFFF) v = 0xFFFF;
+      p[0] = v >> 8;
+      p[1] = v;
+    }
+  } else {
+    addBytes(pixels, pixels, buf, numBytes, colorKeepMask());
+  }
+  forceRefresh();
 }
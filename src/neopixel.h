@@ -7,6 +7,9 @@
   - 800 KHz WS2812, WS2812B, WS2813 and 400kHz bitstream and WS2811
   - 800 KHz bitstream SK6812RGBW (NeoPixel RGBW pixel strips)
     (use 'SK6812RGBW' as PIXEL_TYPE)
+  - 800 KHz bitstream WS2816 and UCS8903 (16 bits per color)
+  - 800 KHz bitstream WS2805 (RGBCW, RGB + cool white + warm white)
+  - APA102 and SK9822 clocked pixels on hardware SPI
 
   Also supports:
   - Radio Shack Tri-Color Strip with TM1803 controller 400kHz bitstream.
@@ -67,6 +70,165 @@
 #define SK6812RGBW     0x06 // 800 KHz datastream (NeoPixel RGBW)
 #define WS2812B_FAST   0x07 // 800 KHz datastream (NeoPixel)
 #define WS2812B2_FAST  0x08 // 800 KHz datastream (NeoPixel)
+#define WS2816         0x09 // 800 KHz datastream, 16 bits per color (GRB)
+#define UCS8903        0x0A // 800 KHz datastream, 16 bits per color (RGB)
+#define WS2805         0x0B // 800 KHz datastream, RGB + cool white + warm white
+#define APA102         0x0C // Clocked SPI (DotStar)
+#define SK9822         0x0D // Clocked SPI (APA102 compatible)
+
+// Color channels of a pixel, as used in NeoPixelType::order and by
+// setPixelChannel()/getPixelChannel()
+#define NEO_CH_R       0x00 // Red
+#define NEO_CH_G       0x01 // Green
+#define NEO_CH_B       0x02 // Blue
+#define NEO_CH_W       0x03 // White (warm white on RGBCW pixels)
+#define NEO_CH_C       0x04 // Cool white
+#define NEO_CH_L       0x05 // 5-bit per-pixel brightness of clocked chips (0-31)
+#define NEO_CH_MAX     6
+
+// Bitstream timing of a pixel type, each with its own default NeoTiming
+#define NEO_TIMING_800KHZ  0x00 // WS2812 timing, 800 KHz
+#define NEO_TIMING_SK6812  0x01 // SK6812 timing, 800 KHz
+#define NEO_TIMING_400KHZ  0x02 // WS2811 timing, 400 KHz
+#define NEO_TIMING_TM1803  0x03 // TM1803 timing, 400 KHz
+#define NEO_TIMING_TM1829  0x04 // TM1829 timing, 800 KHz with inverted bits
+#define NEO_TIMING_CLOCKED 0x05 // Separate clock and data on hardware SPI
+
+// Everything the library needs to know about a pixel type: how its bytes
+// are laid out on the wire and how they are sent.
+struct NeoPixelType {
+  uint8_t  channels;              // Color channels per pixel
+  uint8_t  depth;                 // Bytes per channel (2 = 16 bits, MSB first)
+  uint8_t  order[NEO_CH_MAX];     // NEO_CH_* sent in each position on the wire
+  uint8_t  timing;                // NEO_TIMING_*
+  uint16_t resetUs;               // Latch (reset) time in microseconds
+};
+
+// Pixel types indexed by type flag.  Adding a chip that uses one of the
+// existing timings only needs a type flag and an entry here.
+static constexpr NeoPixelType neoPixelTypes[] = {
+  { 3, 1, { NEO_CH_R, NEO_CH_G, NEO_CH_B }, NEO_TIMING_400KHZ, 50 },  // WS2811
+  { 3, 1, { NEO_CH_R, NEO_CH_G, NEO_CH_B }, NEO_TIMING_800KHZ, 50 },  // (unused)
+  { 3, 1, { NEO_CH_G, NEO_CH_R, NEO_CH_B }, NEO_TIMING_800KHZ, 300 }, // WS2812B
+  { 3, 1, { NEO_CH_R, NEO_CH_G, NEO_CH_B }, NEO_TIMING_TM1803, 24 },  // TM1803
+  { 3, 1, { NEO_CH_R, NEO_CH_B, NEO_CH_G }, NEO_TIMING_TM1829, 500 }, // TM1829
+  { 3, 1, { NEO_CH_G, NEO_CH_R, NEO_CH_B }, NEO_TIMING_800KHZ, 300 }, // WS2812B2
+  { 4, 1, { NEO_CH_R, NEO_CH_G, NEO_CH_B, NEO_CH_W }, NEO_TIMING_SK6812, 80 }, // SK6812RGBW
+  { 3, 1, { NEO_CH_G, NEO_CH_R, NEO_CH_B }, NEO_TIMING_800KHZ, 50 },  // WS2812B_FAST
+  { 3, 1, { NEO_CH_G, NEO_CH_R, NEO_CH_B }, NEO_TIMING_800KHZ, 50 },  // WS2812B2_FAST
+  { 3, 2, { NEO_CH_G, NEO_CH_R, NEO_CH_B }, NEO_TIMING_800KHZ, 300 }, // WS2816
+  { 3, 2, { NEO_CH_R, NEO_CH_G, NEO_CH_B }, NEO_TIMING_800KHZ, 300 }, // UCS8903
+  { 5, 1, { NEO_CH_R, NEO_CH_G, NEO_CH_B, NEO_CH_C, NEO_CH_W }, NEO_TIMING_800KHZ, 300 }, // WS2805
+  { 4, 1, { NEO_CH_L, NEO_CH_B, NEO_CH_G, NEO_CH_R }, NEO_TIMING_CLOCKED, 0 }, // APA102
+  { 4, 1, { NEO_CH_L, NEO_CH_B, NEO_CH_G, NEO_CH_R }, NEO_TIMING_CLOCKED, 0 }, // SK9822
+};
+
+// Bit timing of a single-wire strip, see setTiming().  For TM1829 the
+// high times are the times the (inverted) line is low.
+struct NeoTiming {
+  uint16_t t0hNs;                 // High time of a 0 bit in nanoseconds
+  uint16_t t1hNs;                 // High time of a 1 bit in nanoseconds
+  uint16_t periodNs;              // Length of one bit in nanoseconds
+  uint16_t resetUs;               // Latch (reset) time in microseconds
+};
+
+// Descriptor for a type flag; unknown flags are sent as plain RGB
+constexpr const NeoPixelType& neoPixelType(uint8_t t) {
+  return neoPixelTypes[(t < sizeof(neoPixelTypes) / sizeof(neoPixelTypes[0])) ? t : 1];
+}
+
+// maxRetries value for setRetryPolicy() (nRF52 DWT fallback only)
+#define NEO_RETRY_UNLIMITED 0xFF
+
+// What the nRF52 DWT fallback does after sending a frame
+#define NEO_RETRY_DONE      0 // Not held up for long, the frame is out
+#define NEO_RETRY_AGAIN     1 // Interrupted (over 25% late), send it again
+#define NEO_RETRY_GIVE_UP   2 // Interrupted, but out of retries or time
+
+// Retry policy of the DWT fallback, for an attempt that took
+// 'attemptCycles' to send a frame of 'frameCycles', 'elapsedCycles' after
+// the first attempt started and after 'retries' re-sends.  'maxRetries'
+// and 'budgetCycles' are the limits of setRetryPolicy() (budget 0 = none).
+constexpr uint8_t neoRetryAction(uint32_t attemptCycles, uint32_t frameCycles,
+                                 uint32_t elapsedCycles, uint8_t retries,
+                                 uint8_t maxRetries, uint32_t budgetCycles) {
+  return (attemptCycles < frameCycles + frameCycles / 4) ? NEO_RETRY_DONE :
+         ((maxRetries != NEO_RETRY_UNLIMITED && retries >= maxRetries) ||
+          (budgetCycles != 0 && elapsedCycles >= budgetCycles)) ? NEO_RETRY_GIVE_UP :
+         NEO_RETRY_AGAIN;
+}
+
+// Dithering used to reduce the 16-bit render buffer to 8 bits in show()
+#define NEO_DITHER_NONE      0x00 // Round to nearest
+#define NEO_DITHER_ORDERED   0x01 // Spatial/temporal ordered (Bayer) dither
+#define NEO_DITHER_DIFFUSION 0x02 // Temporal error diffusion (default)
+
+// Pixel bytes encoded per chunk by the P2 SPI and nRF52 PWM backends.
+// Strips longer than two chunks are sent from two alternating chunk
+// buffers instead of one buffer holding the whole encoded frame.
+#ifndef NEO_CHUNK_BYTES
+#define NEO_CHUNK_BYTES 512
+#endif
+
+// Worst-case CPU cycles the bit-banged outputs (STM32, nRF52 fallback)
+// spend between the last bit of one pixel and the first of the next: the
+// loop itself, a palette lookup and white extraction of one pixel, counted
+// from the Cortex-M3/M4 instruction timings.  When the sum for a frame is
+// more than the low time of a 1 bit at the CPU clock, show() looks the
+// whole frame up before interrupts go off instead.
+#ifndef NEO_GAP_CYCLES
+#define NEO_GAP_CYCLES 12
+#endif
+#ifndef NEO_PALETTE_CYCLES
+#define NEO_PALETTE_CYCLES 24
+#endif
+#ifndef NEO_WHITE_CYCLES
+#define NEO_WHITE_CYCLES 130
+#endif
+
+// SPI clock for clocked chips (APA102, SK9822)
+#ifndef NEO_SPI_CLOCK
+#define NEO_SPI_CLOCK 8000000
+#endif
+
+// Build-time options to leave out code a project doesn't use:
+//   NEO_ONLY_TYPE=<type>  all strips are of this pixel type; the type
+//                         argument of the constructors is then ignored
+//   NEO_NO_CLOCKED        no APA102/SK9822 (SPI clocked) output
+//   NEO_NO_PWM            nRF52: no PWM/EasyDMA output, DWT only
+//   NEO_NO_DWT_FALLBACK   nRF52: no DWT output, frames are dropped while
+//                         no PWM device is free
+//   NEO_STM32_DWT         STM32: time every frame with the cycle counter
+//                         instead of the hand-tuned loops
+#ifdef NEO_ONLY_TYPE
+#define NEO_DEFAULT_TYPE (NEO_ONLY_TYPE)
+#else
+#define NEO_DEFAULT_TYPE WS2812B
+#endif
+
+// true for chips that take 16 bits per color (48-bit pixels)
+#define NEO_IS_16BIT(_type) (neoPixelType(_type).depth == 2)
+
+// Bytes per pixel in the 'pixels' buffer for a given type flag
+#define NEO_PIXEL_BYTES(_type) (neoPixelType(_type).channels * neoPixelType(_type).depth)
+
+// Size of the buffer show() encodes a frame of _bytes pixel bytes into:
+// 3 SPI bits per data bit for P2, one 16-bit PWM compare value per data
+// bit plus 2 end values per half buffer for nRF52, the frame itself for
+// the bit-banged platforms (palette and white lookups, see
+// NEO_GAP_CYCLES).  Frames over two chunks are encoded a chunk at a time,
+// so the buffer stops growing there.
+#define NEO_ENCODE_LIMIT(_bytes) \
+  ((uint32_t)(_bytes) < 2 * NEO_CHUNK_BYTES ? (uint32_t)(_bytes) : 2 * NEO_CHUNK_BYTES)
+#if (PLATFORM_ID == 32)
+#define NEO_ENCODE_BYTES(_bytes) (NEO_ENCODE_LIMIT(_bytes) * 3)
+#elif HAL_PLATFORM_NRF52840
+#define NEO_ENCODE_BYTES(_bytes) (NEO_ENCODE_LIMIT(_bytes) * 8 * 2 + 2 * 2 * 2)
+#else
+#define NEO_ENCODE_BYTES(_bytes) (_bytes)
+#endif
+
+template <uint32_t N, uint8_t T> class StaticNeoPixel;
 
 class Adafruit_NeoPixel {
 
@@ -74,63 +236,271 @@ class Adafruit_NeoPixel {
 
   // Constructor: number of LEDs, pin number, LED type
 #if (PLATFORM_ID == 32)
-  Adafruit_NeoPixel(uint16_t n, SPIClass& spi, uint8_t t=WS2812B);
+  Adafruit_NeoPixel(uint32_t n, SPIClass& spi, uint8_t t=NEO_DEFAULT_TYPE);
 #else
-  Adafruit_NeoPixel(uint16_t n, uint8_t p=2, uint8_t t=WS2812B);
+  Adafruit_NeoPixel(uint32_t n, uint8_t p=2, uint8_t t=NEO_DEFAULT_TYPE);
+  // Clocked chips (APA102, SK9822) on a hardware SPI interface
+  Adafruit_NeoPixel(uint32_t n, SPIClass& spi, uint8_t t);
 #endif // #if (PLATFORM_ID == 32)
   ~Adafruit_NeoPixel();
 
+  // Strips own their pixel buffer and output pin, so they can be moved
+  // (e.g. into a container) but not copied.  A StaticNeoPixel's buffers
+  // are part of it and can't be moved out; moving it through a base
+  // reference leaves it as is and the target empty.
+  Adafruit_NeoPixel(Adafruit_NeoPixel&& other) noexcept;
+  Adafruit_NeoPixel& operator=(Adafruit_NeoPixel&& other) noexcept;
+  Adafruit_NeoPixel(const Adafruit_NeoPixel&) = delete;
+  Adafruit_NeoPixel& operator=(const Adafruit_NeoPixel&) = delete;
+  template <uint32_t N, uint8_t T>
+  Adafruit_NeoPixel(StaticNeoPixel<N, T>&&) = delete;
+  template <uint32_t N, uint8_t T>
+  Adafruit_NeoPixel& operator=(StaticNeoPixel<N, T>&&) = delete;
+
   void
     begin(void),
     show(void) __attribute__((optimize("Ofast"))),
     setPin(uint8_t p),
-    setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b),
-    setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w),
-    setPixelColor(uint16_t n, uint32_t c),
+    setPixelColor(uint32_t n, uint8_t r, uint8_t g, uint8_t b),
+    setPixelColor(uint32_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w),
+    setPixelColor(uint32_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w, uint8_t c),
+    setPixelChannel(uint32_t n, uint8_t ch, uint8_t v),
+    setPixelColor(uint32_t n, uint32_t c),
     setBrightness(uint8_t),
-    setColor(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue),
-    setColor(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite),
-    setColorScaled(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aScaling),
-    setColorScaled(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite, byte aScaling),
-    setColorDimmed(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aBrightness),
-    setColorDimmed(uint16_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite, byte aBrightness),
-    updateLength(uint16_t n),
+    setColor(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue),
+    setColor(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite),
+    setColorScaled(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aScaling),
+    setColorScaled(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite, byte aScaling),
+    setColorDimmed(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aBrightness),
+    setColorDimmed(uint32_t aLedNumber, byte aRed, byte aGreen, byte aBlue, byte aWhite, byte aBrightness),
+    updateLength(uint32_t n),
+    attachBuffer(uint8_t* buf, uint32_t bytes),
+    attachBuffer(const uint8_t* buf, uint32_t bytes),
+    setPaletteColor(uint8_t index, uint32_t c),
+    setPixelIndex(uint32_t n, uint8_t index),
+    setPixelColor16(uint32_t n, uint16_t r, uint16_t g, uint16_t b, uint16_t w=0),
+    setDither(uint8_t mode),
+    resetTiming(void),
+    setSkipUnchanged(bool enable),
+    forceRefresh(void),
+    fadeToBlack(uint8_t amount),
+    blend(const uint8_t *buf, uint8_t amount),
+    blend(const uint8_t *from, const uint8_t *to, uint8_t amount),
+    blendAlpha(const uint8_t *from, const uint8_t *to, const uint8_t *alpha),
+    addColors(const uint8_t *buf),
+    rainbow(uint16_t firstHue=0, int8_t reps=1, uint8_t sat=255, uint8_t val=255, bool gamma=true),
+    fillNoise(uint32_t first, uint32_t count, uint16_t scale, uint32_t time,
+              uint8_t octaves=1, uint32_t c0=0, uint32_t c1=0xFFFFFF),
+    fillNoise2D(uint16_t width, uint16_t height, bool serpentine, uint16_t scale, uint32_t time,
+                uint8_t octaves=1, uint32_t c0=0, uint32_t c1=0xFFFFFF),
     clear(void);
   uint8_t
    *getPixels() const,
+    getPixelIndex(uint32_t n) const,
+    getPixelChannel(uint32_t n, uint8_t ch) const,
     getBrightness(void) const,
     getPin() const,
     getType() const;
-  uint16_t
+  bool
+    reserve(uint32_t n),
+    setPaletteMode(uint8_t bits),
+    set16BitBuffer(bool enable),
+    setWhiteExtraction(bool enable, uint32_t white=0xFFFFFF),
+    setTiming(const NeoTiming& t),
+    getDirtyRange(uint32_t& first, uint32_t& count) const;
+  NeoTiming
+    getTiming(void) const;
+  uint32_t
     numPixels(void) const,
     getNumLeds(void) const;
   static uint32_t
     Color(uint8_t r, uint8_t g, uint8_t b),
-    Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w);
+    Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w),
+    ColorHSV(uint16_t hue, uint8_t sat=255, uint8_t val=255, bool gamma=false),
+    gamma32(uint32_t c);
+  static uint8_t
+    gamma8(uint8_t x),
+    noise8(uint32_t x, uint32_t y, uint32_t z);
   uint32_t
-    getPixelColor(uint16_t n) const;
+    getPixelColor(uint32_t n) const,
+    getBlackoutMicros(void) const,
+    getDriftMicros(void) const,
+    getSkippedFrames(void) const;
   byte
     brightnessToPWM(byte aBrightness);
+#if HAL_PLATFORM_NRF52840
+  void
+    setRetryPolicy(uint8_t maxRetries, uint32_t budgetUs=0);
+  uint8_t
+    getRetryCount(void) const;
+  uint32_t
+    getGiveUpCount(void) const;
+#endif
+#if (PLATFORM_ID == 32) || HAL_PLATFORM_NRF52840
+  bool
+    setFrameCache(uint32_t bytes);
+  uint32_t
+    getCacheHits(void) const,
+    getCacheMisses(void) const;
+#endif
+
+ protected:
+
+  // Constructor for strips with caller-provided storage: 'buf' holds up to
+  // 'bufBytes' of pixel data and 'enc' is used to encode frames in show().
+  // NULL buffers are allocated from the heap as needed.
+#if (PLATFORM_ID == 32)
+  Adafruit_NeoPixel(uint32_t n, SPIClass& spi, uint8_t t,
+                    uint8_t* buf, uint32_t bufBytes, uint8_t* enc, uint32_t encBytes);
+#else
+  Adafruit_NeoPixel(uint32_t n, uint8_t p, uint8_t t,
+                    uint8_t* buf, uint32_t bufBytes, uint8_t* enc, uint32_t encBytes);
+  Adafruit_NeoPixel(uint32_t n, SPIClass& spi, uint8_t t,
+                    uint8_t* buf, uint32_t bufBytes, uint8_t* enc, uint32_t encBytes);
+#endif // #if (PLATFORM_ID == 32)
 
  private:
 
+  void
+    irqBlackout(uint32_t cycles),
+    showClocked(void),
+    blankColors(uint8_t *p, uint32_t bytes) const,
+    markDirty(uint32_t first, uint32_t count),
+    storeNoise(uint32_t n, uint8_t level, const uint8_t *from, const uint8_t *to),
+    release(void),
+    moveFrom(Adafruit_NeoPixel& other),
+    disown(void),
+    storeChannels(uint8_t *p, uint8_t *v, uint8_t used),
+    expandPalette(uint8_t *out, uint32_t first, uint32_t count) const,
+    extractWhite(uint8_t *wire, uint32_t count) const,
+    reduce16(void),
+    encodePixels(void (*encode)(uint8_t*, const uint8_t*, uint32_t), uint8_t expansion,
+                 uint8_t *out, uint32_t first, uint32_t count) const;
   bool
-    begun;         // true if begin() previously called
-  uint16_t
-    numLEDs,       // Number of RGB LEDs in strip
-    numBytes;      // Size of 'pixels' buffer below
+    reserveBytes(uint32_t bytes),
+    resize16(uint32_t oldBytes);
+  uint32_t
+    storageBytes(uint32_t n) const,
+    colorKeepMask(void) const;
   const uint8_t
-    type;          // Pixel type flag (400 vs 800 KHz)
+   *wirePixel(uint32_t n, uint8_t *buf) const;
+  uint8_t
+   *expandFrame(uint32_t lowCycles);
+
+  bool
+    begun,         // true if begin() previously called
+    ownPixels,     // true if 'pixels' is heap allocated by updateLength()
+    constPixels,   // true if 'pixels' is a read-only attached buffer
+    fixedBuffers,  // true if the buffers are members of a StaticNeoPixel
+    customTiming,  // true if 'profile' replaces the type's default timing
+    skipUnchanged; // true if show() skips frames with nothing changed
+  uint32_t
+    numLEDs,       // Number of RGB LEDs in strip
+    numBytes,      // Size of 'pixels' buffer below
+    maxBytes;      // Capacity of 'pixels'
   uint8_t
+    type,          // Pixel type flag (400 vs 800 KHz)
     pin,           // Output pin number
     brightness,
-   *pixels;        // Holds LED color values (3 bytes each)
+    paletteBits,   // Bits per palette index in 'pixels' (0 = direct color)
+   *pixels,        // Holds LED color values (3 bytes each) or palette indices
+   *palette,       // Palette colors in wire order, used if paletteBits != 0
+    ditherMode,    // NEO_DITHER_* used by reduce16()
+    ditherFrame,   // Frame counter for temporal ordered dithering
+   *ditherErr;     // Per channel error carried between frames (diffusion)
+  uint16_t
+   *pixels16;      // 16-bit render buffer in wire order, or NULL
+  uint8_t
+   *encodeBuf;     // Fixed frame encode buffer, or NULL to allocate per frame
+  uint32_t
+    encodeBytes,   // Size of 'encodeBuf'
+    endTime,       // Latch timing reference
+    blackoutUs,    // Interrupts-off time of the last show() in microseconds
+    driftUs,       // SysTick time lost to show(), summed over all frames
+    whiteColor,    // RGB color of the white LED for white extraction, 0 = off
+    dirtyFirst,    // First pixel changed since the last show()
+    dirtyEnd,      // One past the last changed pixel (dirtyFirst >= dirtyEnd: none)
+    skippedFrames; // show() calls skipped by skipUnchanged
+  uint8_t
+    whitePos[4];   // Wire positions of R, G, B and W for white extraction
+  uint16_t
+    whiteMul[3];   // W level each of R, G, B allows per unit, x256
+  NeoTiming
+    profile;       // Timing set with setTiming(), if customTiming
+  SPIClass
+   *spi_;          // SPI interface (P2, clocked chips), or NULL
+#if HAL_PLATFORM_NRF52840
+  void
+    claimPwm(void),
+    timePwm(void),
+    releasePwm(void);
+  void
+   *pwm;           // PWM device (NRF_PWM_Type) kept claimed between frames
+  uint16_t
+    pwmT0H,        // PWM compare values of a 0 and a 1 bit, set by timePwm()
+    pwmT1H;
+  uint8_t
+    retryMax,      // Max DWT re-sends per frame (NEO_RETRY_UNLIMITED = no limit)
+    lastRetries;   // DWT re-sends needed by the last show()
   uint32_t
-    endTime;       // Latch timing reference
+    retryBudgetUs, // Max time spent re-sending per frame (0 = no limit)
+    giveUps;       // Frames abandoned by the retry policy
+#endif
+#if (PLATFORM_ID == 32) || HAL_PLATFORM_NRF52840
+  uint8_t
+   *cacheFrame(uint32_t encBytes, bool& hit);
+  uint8_t
+   *cachePool;     // Encoded frame cache (see setFrameCache()), or NULL
+  uint32_t
+    cacheBytes,    // Size of 'cachePool'
+    cacheSlotBytes,// Size of one cache entry for the current frame size
+    cacheSlots,    // Entries that fit in 'cachePool'
+    cacheClock,    // Lookup counter, for least recently used eviction
+    cacheHits,     // Frames sent from the cache
+    cacheMisses;   // Frames encoded into the cache
+#endif
+};
+
+// Strip with statically sized storage for N pixels of type T.  The pixel
+// buffer and the worst-case encode buffer are members, so show() takes
+// nothing from the heap and the RAM cost is known at link time.  Only the
+// opt-in extras (palette, 16-bit render buffer, frame cache) allocate, when
+// they are turned on.  updateLength() accepts lengths up to N.
+template <uint32_t N, uint8_t T = NEO_DEFAULT_TYPE>
+class StaticNeoPixel : public Adafruit_NeoPixel {
+
+ public:
+
 #if (PLATFORM_ID == 32)
-  SPIClass*
-    spi_;
+  StaticNeoPixel(SPIClass& spi) :
+    Adafruit_NeoPixel(N, spi, T, buf_, sizeof(buf_), ENCODE_BYTES ? enc_ : NULL, ENCODE_BYTES) {}
+#else
+  StaticNeoPixel(uint8_t p=2) :
+    Adafruit_NeoPixel(N, p, T, buf_, sizeof(buf_), ENCODE_BYTES ? enc_ : NULL, ENCODE_BYTES) {}
+  StaticNeoPixel(SPIClass& spi) :
+    Adafruit_NeoPixel(N, spi, T, buf_, sizeof(buf_), NULL, 0) {}
+#endif // #if (PLATFORM_ID == 32)
+
+  // The buffers live inside the object, so they can't be handed over
+  StaticNeoPixel(const StaticNeoPixel&) = delete;
+  StaticNeoPixel& operator=(const StaticNeoPixel&) = delete;
+
+ private:
+
+#ifdef NEO_ONLY_TYPE
+  static_assert(T == (NEO_ONLY_TYPE), "pixel type differs from NEO_ONLY_TYPE");
 #endif
+#ifdef NEO_NO_CLOCKED
+  static_assert(neoPixelType(T).timing != NEO_TIMING_CLOCKED,
+                "clocked pixel type built with NEO_NO_CLOCKED");
+#endif
+
+  static const uint32_t ENCODE_BYTES = NEO_ENCODE_BYTES(N * NEO_PIXEL_BYTES(T));
+
+  uint8_t
+    buf_[N * NEO_PIXEL_BYTES(T)];
+  uint8_t
+    enc_[ENCODE_BYTES ? ENCODE_BYTES : 1] __attribute__((aligned(4)));
 };
 
 #endif // PARTICLE_NEOPIXEL_H
@@ -0,0 +1,101 @@
+/* ===================== neopixel_math.h ===================== */
+/*--------------------------------------------------------------------
+  This file is part of the Adafruit NeoPixel library.
+
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Fixed-point helpers for effects: no floats and no divides, only
+// multiplies and shifts (single cycle on Cortex-M3/M4/M33).  All of them
+// are constexpr, so constant arguments fold at compile time.  Not included
+// by neopixel.h, to stay out of the way of other libraries with the same
+// names (e.g. FastLED).
+
+#ifndef PARTICLE_NEOPIXEL_MATH_H
+#define PARTICLE_NEOPIXEL_MATH_H
+
+#include <stdint.h>
+
+// i * scale / 256, with scale 255 keeping i (scale8(255, 255) == 255)
+constexpr uint8_t scale8(uint8_t i, uint8_t scale) {
+  return ((uint32_t)i * (1 + (uint32_t)scale)) >> 8;
+}
+
+// i * scale / 65536, with scale 65535 keeping i
+constexpr uint16_t scale16(uint16_t i, uint16_t scale) {
+  return ((uint32_t)i * (1 + (uint32_t)scale)) >> 16;
+}
+
+// Saturating add and subtract
+constexpr uint8_t qadd8(uint8_t i, uint8_t j) {
+  return ((uint32_t)i + j > 255) ? 255 : i + j;
+}
+
+constexpr uint8_t qsub8(uint8_t i, uint8_t j) {
+  return (i > j) ? i - j : 0;
+}
+
+// From a (frac 0) toward b (frac 255 gives b)
+constexpr uint8_t lerp8(uint8_t a, uint8_t b, uint8_t frac) {
+  return (b >= a) ? a + scale8(b - a, frac) : a - scale8(a - b, frac);
+}
+
+// Quarter sine wave, round(127 * sin(k * pi / 128)) for k = 0..64
+static constexpr uint8_t neoSinQuarter[65] = {
+    0,   3,   6,   9,  12,  16,  19,  22,  25,  28,  31,  34,  37,  40,  43,  46,
+   49,  51,  54,  57,  60,  63,  65,  68,  71,  73,  76,  78,  81,  83,  85,  88,
+   90,  92,  94,  96,  98, 100, 102, 104, 106, 107, 109, 111, 112, 113, 115, 116,
+  117, 118, 120, 121, 122, 122, 123, 124, 125, 125, 126, 126, 126, 127, 127, 127,
+  127
+};
+
+// Sine of 'theta' (256 steps per turn) as 1..255 around 128
+constexpr uint8_t sin8(uint8_t theta) {
+  return (theta & 0x80)
+    ? 128 - neoSinQuarter[(theta & 0x40) ? 64 - (theta & 0x3F) : (theta & 0x3F)]
+    : 128 + neoSinQuarter[(theta & 0x40) ? 64 - (theta & 0x3F) : (theta & 0x3F)];
+}
+
+constexpr uint8_t cos8(uint8_t theta) {
+  return sin8(theta + 64);
+}
+
+// Triangle wave: 0 up to 254 at 127/128 and back down to 0
+constexpr uint8_t triwave8(uint8_t x) {
+  return ((x & 0x80) ? 255 - x : x) << 1;
+}
+
+// Phase (65536 per beat) of a 'bpm' beats per minute wave at 'ms'
+// milliseconds, e.g. millis().  65536 / 60000 is taken as 280 / 256 (0.14%
+// fast, 5 seconds an hour); the product may wrap, the bits used stay exact.
+constexpr uint16_t beat16(uint16_t bpm, uint32_t ms) {
+  return (ms * bpm * 280UL) >> 8;
+}
+
+constexpr uint8_t beat8(uint16_t bpm, uint32_t ms) {
+  return beat16(bpm, ms) >> 8;
+}
+
+// Sine wave between 'low' and 'high' at 'bpm' beats per minute
+constexpr uint8_t beatsin8(uint16_t bpm, uint8_t low, uint8_t high, uint32_t ms) {
+  return low + scale8(sin8(beat8(bpm, ms)), high - low);
+}
+
+// Triangle wave between 'low' and 'high' at 'bpm' beats per minute
+constexpr uint8_t beattri8(uint16_t bpm, uint8_t low, uint8_t high, uint32_t ms) {
+  return low + scale8(triwave8(beat8(bpm, ms)), high - low);
+}
+
+#endif // PARTICLE_NEOPIXEL_MATH_H
@@ -0,0 +1,361 @@
+/*--------------------------------------------------------------------
+  Host benchmarks: make -C test bench.  Times are from the PC running
+  them, so only the ratios between rows (e.g. fixed point against float)
+  carry over to a device.
+  --------------------------------------------------------------------*/
+
+#include "neo_test.h"
+#include "neopixel_math.h"
+#include <math.h>
+#include <chrono>
+
+static volatile uint32_t benchSink; // Keeps results from being optimized out
+
+static void report(const char *name, double ns) {
+  printf("  %-34s %9.2f ns/op\n", name, ns);
+}
+
+// Runs 'f' once to warm up, then a few more times, prints the best time
+// per operation and returns it
+template <typename F> static double bench(const char *name, uint32_t ops, F f) {
+  f();
+  double best = 0;
+  for (int run = 0; run < 5; run++) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - start;
+    if (run == 0 || ns.count() < best) best = ns.count();
+  }
+  report(name, best / ops);
+  return best / ops;
+}
+
+// ---- neopixel_math.h (user-049) ----
+static void benchMath(void) {
+  const uint32_t n = 1 << 22;
+  printf("neopixel_math.h, %u ops each\n", n);
+  bench("scale8", n, [&] {
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) acc += scale8(i, i >> 8);
+    benchSink = acc;
+  });
+  bench("float i * s / 255", n, [&] {
+    float acc = 0;
+    for (uint32_t i = 0; i < n; i++) acc += (float)(uint8_t)i * (float)(uint8_t)(i >> 8) / 255.0f;
+    benchSink = (uint32_t)acc;
+  });
+  bench("lerp8", n, [&] {
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) acc += lerp8(i, i >> 8, i >> 16);
+    benchSink = acc;
+  });
+  bench("float lerp", n, [&] {
+    float acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      float a = (uint8_t)i, b = (uint8_t)(i >> 8);
+      acc += a + (b - a) * (float)(uint8_t)(i >> 16) / 255.0f;
+    }
+    benchSink = (uint32_t)acc;
+  });
+  bench("sin8", n, [&] {
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) acc += sin8(i);
+    benchSink = acc;
+  });
+  bench("sinf", n, [&] {
+    float acc = 0;
+    for (uint32_t i = 0; i < n; i++) acc += 128 + 127 * sinf((uint8_t)i * (float)(2 * M_PI / 256));
+    benchSink = (uint32_t)acc;
+  });
+  bench("beatsin8", n, [&] {
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) acc += beatsin8(60, 20, 200, i);
+    benchSink = acc;
+  });
+  bench("float beatsin", n, [&] {
+    float acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      acc += 20 + 180 * (0.5f + 0.5f * sinf((float)(2 * M_PI) * 60 * i / 60000.0f));
+    }
+    benchSink = (uint32_t)acc;
+  });
+}
+
+// ---- Strip operations ----
+static const uint32_t STRIP = 300, FRAMES = 2000;
+
+static void fillBytes(uint8_t *p, uint32_t bytes, uint32_t seed) {
+  for (uint32_t i = 0; i < bytes; i++) p[i] = (i * 37 + seed) >> 1;
+}
+
+// Against the per-byte loops the word-at-a-time kernels replaced (user-046)
+static void benchBulk(void) {
+  printf("bulk color operations, %u RGB pixels\n", STRIP);
+  Adafruit_NeoPixel strip(STRIP, NEO_TEST_OUT, WS2812B);
+  uint8_t *p = strip.getPixels();
+  uint32_t bytes = STRIP * 3;
+  static uint8_t other[STRIP * 3];
+  fillBytes(other, bytes, 5);
+  fillBytes(p, bytes, 1);
+
+  bench("fadeToBlack", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) strip.fadeToBlack(1);
+  });
+  bench("per-byte scale", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      for (uint32_t i = 0; i < bytes; i++) p[i] = (p[i] * 255) >> 8;
+      benchSink = p[f % bytes];
+    }
+  });
+  bench("blend", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) strip.blend(other, f);
+  });
+  bench("per-byte blend", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      uint32_t t = (uint8_t)f;
+      for (uint32_t i = 0; i < bytes; i++) p[i] = (p[i] * (256 - t) + other[i] * t) >> 8;
+      benchSink = p[f % bytes];
+    }
+  });
+  bench("addColors", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      strip.fadeToBlack(128);
+      strip.addColors(other);
+    }
+  });
+  bench("per-byte add", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      strip.fadeToBlack(128);
+      for (uint32_t i = 0; i < bytes; i++) {
+        uint32_t v = p[i] + other[i];
+        p[i] = v > 255 ? 255 : v;
+      }
+      benchSink = p[f % bytes];
+    }
+  });
+}
+
+// nRF52 show() with the nibble table encoder (user-028).  The stub PWM
+// copies the sequence it plays, so the encoding alone is the difference to
+// a show() of a frame found in the cache.  The per-bit loop is the encoder
+// the table replaced.
+static void benchPwm(void) {
+#if HAL_PLATFORM_NRF52840
+  printf("nRF52 show(), %u pixels\n", STRIP);
+  Adafruit_NeoPixel strip(STRIP, 2, WS2812B);
+  strip.begin();
+  uint32_t bytes = STRIP * 3;
+  fillBytes(strip.getPixels(), bytes, 1);
+  auto shows = [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      stubReset();
+      strip.show();
+    }
+  };
+  double full = bench("show()", FRAMES, shows);
+  strip.setFrameCache(32768);
+  strip.show();
+  double cached = bench("show() of a cached frame", FRAMES, shows);
+  strip.setFrameCache(0);
+  report("nibble table encoding (difference)", full - cached);
+
+  static uint16_t pattern[STRIP * 3 * 8 + 2];
+  bench("per-bit loop encoding", FRAMES, [&] {
+    const uint8_t *in = strip.getPixels();
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      uint32_t pos = 0;
+      for (uint32_t n = 0; n < bytes; n++) {
+        uint8_t pix = in[n];
+        for (uint8_t mask = 0x80; mask > 0; mask >>= 1) {
+          pattern[pos++] = (pix & mask) ? (13 | 0x8000) : (6 | 0x8000);
+        }
+      }
+      pattern[pos] = pattern[pos + 1] = 0x8000;
+      benchSink = pattern[f % pos];
+    }
+  });
+#endif
+}
+
+// show() with the 16-bit render buffer reduced to 8 bits (user-036), the
+// difference to the 8-bit row being the reduction.  On the PWM (nRF52) and
+// SPI (P2) outputs; the STM32 output is a cycle-timed bit-bang with
+// nothing to measure on a PC.
+static void benchRender16(void) {
+#if HAL_PLATFORM_NRF52840 || (PLATFORM_ID == 32)
+  printf("show() with the 16-bit buffer, %u pixels\n", STRIP);
+  Adafruit_NeoPixel strip(STRIP, NEO_TEST_OUT, WS2812B);
+  strip.begin();
+  fillBytes(strip.getPixels(), STRIP * 3, 1);
+  auto shows = [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      stubReset();
+      strip.show();
+    }
+  };
+  double plain = bench("8-bit buffer", FRAMES, shows);
+  strip.set16BitBuffer(true);
+  report("error diffusion (difference)", bench("16-bit, error diffusion", FRAMES, shows) - plain);
+  strip.setDither(NEO_DITHER_ORDERED);
+  report("ordered dither (difference)", bench("16-bit, ordered dither", FRAMES, shows) - plain);
+  strip.setDither(NEO_DITHER_NONE);
+  report("rounding (difference)", bench("16-bit, no dither", FRAMES, shows) - plain);
+#endif
+}
+
+// setBrightness() rescales the whole buffer; native 16-bit chips (user-037)
+// scale channel pairs
+static void benchBrightness(void) {
+  printf("setBrightness, %u pixels, down and back up\n", STRIP);
+  Adafruit_NeoPixel rgb(STRIP, NEO_TEST_OUT, WS2812B), wide(STRIP, NEO_TEST_OUT, WS2816);
+  fillBytes(rgb.getPixels(), STRIP * 3, 1);
+  fillBytes(wide.getPixels(), STRIP * 6, 1);
+  bench("8-bit WS2812B", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) rgb.setBrightness((f & 1) ? 255 : 100);
+  });
+  bench("16-bit WS2816", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) wide.setBrightness((f & 1) ? 255 : 100);
+  });
+}
+
+// Crossfade of two rendered frames in one pass and the per-pixel alpha
+// blend (user-047), against copying a frame and blending the other in,
+// and a getPixelColor()/setPixelColor() loop
+static void benchCrossfade(void) {
+  printf("crossfade, %u RGB pixels\n", STRIP);
+  Adafruit_NeoPixel strip(STRIP, NEO_TEST_OUT, WS2812B);
+  uint8_t *p = strip.getPixels();
+  uint32_t bytes = STRIP * 3;
+  static uint8_t from[STRIP * 3], to[STRIP * 3], alpha[STRIP];
+  fillBytes(from, bytes, 3);
+  fillBytes(to, bytes, 7);
+  fillBytes(alpha, STRIP, 9);
+  bench("blend(from, to)", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) strip.blend(from, to, f);
+  });
+  bench("copy + blend(buf)", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      memcpy(p, from, bytes);
+      strip.blend(to, f);
+    }
+  });
+  bench("blendAlpha", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) strip.blendAlpha(from, to, alpha);
+  });
+  Adafruit_NeoPixel a(STRIP, NEO_TEST_OUT, WS2812B), b(STRIP, NEO_TEST_OUT, WS2812B);
+  memcpy(a.getPixels(), from, bytes);
+  memcpy(b.getPixels(), to, bytes);
+  bench("per-pixel get/setPixelColor", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      for (uint32_t n = 0; n < STRIP; n++) {
+        uint32_t ca = a.getPixelColor(n), cb = b.getPixelColor(n), t = alpha[n];
+        strip.setPixelColor(n, ((ca >> 16 & 0xFF) * (255 - t) + (cb >> 16 & 0xFF) * t) / 255,
+                               ((ca >> 8 & 0xFF) * (255 - t) + (cb >> 8 & 0xFF) * t) / 255,
+                               ((ca & 0xFF) * (255 - t) + (cb & 0xFF) * t) / 255);
+      }
+    }
+  });
+}
+
+// Color wheel of the strandtest examples
+static uint32_t wheel(uint8_t pos) {
+  pos = 255 - pos;
+  if (pos < 85) return Adafruit_NeoPixel::Color(255 - pos * 3, 0, pos * 3);
+  if (pos < 170) {
+    pos -= 85;
+    return Adafruit_NeoPixel::Color(0, pos * 3, 255 - pos * 3);
+  }
+  pos -= 170;
+  return Adafruit_NeoPixel::Color(pos * 3, 255 - pos * 3, 0);
+}
+
+// One-pass rainbow() (user-048) against setting each pixel from Wheel(),
+// which has no gamma, and from ColorHSV() with the same gamma
+static void benchRainbow(void) {
+  printf("rainbow, %u pixels\n", STRIP);
+  Adafruit_NeoPixel strip(STRIP, NEO_TEST_OUT, WS2812B);
+  bench("rainbow, no gamma", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) strip.rainbow(f * 256, 1, 255, 255, false);
+  });
+  bench("setPixelColor(Wheel)", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      for (uint32_t n = 0; n < STRIP; n++) strip.setPixelColor(n, wheel((n * 256 / STRIP + f) & 255));
+    }
+  });
+  bench("rainbow, gamma", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) strip.rainbow(f * 256);
+  });
+  bench("setPixelColor(ColorHSV, gamma)", FRAMES, [&] {
+    for (uint32_t f = 0; f < FRAMES; f++) {
+      for (uint32_t n = 0; n < STRIP; n++) {
+        strip.setPixelColor(n, Adafruit_NeoPixel::ColorHSV(f * 256 + n * 65536 / STRIP, 255, 255, true));
+      }
+    }
+  });
+}
+
+// Noise fills (user-050) against their budget: 1000 pixels at 100 fps on a
+// Photon, 10 ms a frame on a 120 MHz Cortex-M3, with half of it to spare.
+// The PC time is turned into PC cycles with the clock measured next to
+// it, then into M3 cycles with PC_IPC_PER_M3: an out-of-order PC core
+// runs about 4 times the instructions per cycle of the single-issue M3 on
+// integer code like this (the M3 takes 2 cycles per load and 3 per taken
+// branch).
+static const double PC_IPC_PER_M3 = 4, M3_HZ = 120e6, NOISE_BUDGET_MS = 10;
+
+// PC cycles per ns: a chain of dependent adds runs one per cycle
+static double pcClockGHz(void) {
+  const uint32_t n = 1 << 22;
+  double best = 0;
+  for (int run = 0; run < 6; run++) {
+    uint32_t x = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < n; i++) {
+      x += i;
+      __asm__ volatile("" : "+r"(x));
+    }
+    std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - start;
+    if (run > 0 && (best == 0 || ns.count() < best)) best = ns.count();
+    benchSink = x;
+  }
+  return n / best;
+}
+
+// Returns the number of fills over the budget
+static int benchNoise(void) {
+  const uint32_t pixels = 1000, frames = 200;
+  printf("noise fills, %u pixels, budget %.0f ms a frame on a 120 MHz M3\n", pixels, NOISE_BUDGET_MS);
+  Adafruit_NeoPixel strip(pixels, NEO_TEST_OUT, WS2812B);
+  int over = 0;
+  auto check = [&](double ns) {
+    double ms = ns * pcClockGHz() * PC_IPC_PER_M3 / M3_HZ * 1e3;
+    bool ok = ms <= NOISE_BUDGET_MS / 2;
+    printf("  %-34s %9.2f ms %s\n", "  on the M3 (estimate)", ms, ok ? "" : "OVER BUDGET");
+    over += !ok;
+  };
+  check(bench("fillNoise, 1 octave", frames, [&] {
+    for (uint32_t f = 0; f < frames; f++) strip.fillNoise(0, pixels, 24, f * 8);
+  }));
+  check(bench("fillNoise, 2 octaves", frames, [&] {
+    for (uint32_t f = 0; f < frames; f++) strip.fillNoise(0, pixels, 24, f * 8, 2);
+  }));
+  check(bench("fillNoise2D 40x25, 1 octave", frames, [&] {
+    for (uint32_t f = 0; f < frames; f++) strip.fillNoise2D(40, 25, true, 40, f * 8);
+  }));
+  bench("fillNoise, 4 octaves (no budget)", frames, [&] {
+    for (uint32_t f = 0; f < frames; f++) strip.fillNoise(0, pixels, 24, f * 8, 4);
+  });
+  return over;
+}
+
+int neoBenchMain(void) {
+  printf("platform %d\n", PLATFORM_ID);
+  benchMath();
+  benchBulk();
+  benchPwm();
+  benchRender16();
+  benchBrightness();
+  benchCrossfade();
+  benchRainbow();
+  return benchNoise() ? 1 : 0;
+}
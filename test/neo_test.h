@@ -0,0 +1,87 @@
+/*--------------------------------------------------------------------
+  Minimal host test framework for the NeoPixel library, and access to
+  what the stub peripherals recorded (see stub/Particle.h).
+  --------------------------------------------------------------------*/
+
+#ifndef NEO_TEST_H
+#define NEO_TEST_H
+
+#include "neopixel.h"
+#include <stdio.h>
+#include <vector>
+
+// ---- Tests ----
+typedef void (*NeoTestFn)(void);
+struct NeoTestReg {
+  NeoTestReg(const char *name, NeoTestFn fn);
+};
+
+#define NEO_TEST(name) \
+  static void name(void); \
+  static NeoTestReg name##_reg(#name, name); \
+  static void name(void)
+
+extern int neoTestFailures;
+void neoTestFail(const char *file, int line, const char *expr, long long a, long long b);
+
+#define CHECK(cond) \
+  do { if (!(cond)) neoTestFail(__FILE__, __LINE__, #cond, 0, 0); } while (0)
+#define CHECK_EQ(a, b) \
+  do { long long _a = (long long)(a), _b = (long long)(b); \
+       if (_a != _b) neoTestFail(__FILE__, __LINE__, #a " == " #b, _a, _b); } while (0)
+
+// Output of a single-wire strip: a pin, or the SPI interface on P2
+#if (PLATFORM_ID == 32)
+#define NEO_TEST_OUT SPI
+#else
+#define NEO_TEST_OUT 2
+#endif
+
+// ---- What the stub peripherals recorded ----
+struct StubEdge {
+  uint32_t cycle;     // DWT cycle count at the write
+  uint8_t level;      // Level driven from then on
+};
+struct StubSpiTransfer {
+  const uint8_t *tx;  // Memory the transfer read from
+  size_t bytes;
+  bool async;         // Started with a completion callback
+  bool singleThreaded; // Started inside SINGLE_THREADED_BLOCK()
+};
+
+extern std::vector<StubEdge> stubEdges;          // Pin writes (STM32, nRF52 DWT)
+extern std::vector<uint8_t> stubSpiOut;          // Bytes sent by SPI
+extern std::vector<StubSpiTransfer> stubSpiTransfers;
+extern std::vector<uint16_t> stubPwmOut;         // Compare values played by PWM
+extern uint32_t stubAllocs;                      // malloc()/realloc() calls
+extern bool stubPwmBusy;                         // All nRF52 PWM devices taken
+
+// Clear the records and the allocation count
+void stubReset(void);
+
+// Data bytes of the recorded pin edges: a high time of 'thresholdCycles'
+// or more is a 1 bit.  'starts' (optional) gets the cycle of each bit start.
+std::vector<uint8_t> stubDecodeEdges(uint32_t thresholdCycles,
+                                     std::vector<uint32_t> *starts = NULL);
+
+// Data bytes of the recorded PWM values (T1H compare value = 1 bit),
+// up to the first end value
+std::vector<uint8_t> stubDecodePwm(void);
+
+// Data bytes of the recorded SPI output of the P2 3-bit encoding, skipping
+// the reset (zero) bytes
+std::vector<uint8_t> stubDecodeSpi(void);
+
+// ---- Test data ----
+// Deterministic pseudo-random bytes
+uint8_t testRandomByte(void);
+std::vector<uint8_t> testRandomFrame(size_t bytes);
+
+// Fill the strip's buffer with testRandomByte() and return a copy of it
+std::vector<uint8_t> testRandomize(Adafruit_NeoPixel &strip);
+
+// Whether byte i of the strip's buffer is a color (not the APA102
+// brightness byte)
+bool testIsColorByte(const Adafruit_NeoPixel &strip, uint32_t i);
+
+#endif // NEO_TEST_H
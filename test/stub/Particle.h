@@ -0,0 +1,137 @@
+/*--------------------------------------------------------------------
+  Host stand-in for the parts of Device OS the NeoPixel library uses, so
+  that it can be built and tested on a PC.  PLATFORM_ID selects the
+  platform family like on a device:
+    6  (Photon)  STM32 with DWT cycle counter and GPIO set/reset registers
+    12 (Argon)   nRF52840 with PWM/EasyDMA and DWT cycle counter
+    32 (P2)      RTL872x with SPI output
+
+  The peripherals record what they are made to do (pin edges with their
+  cycle count, SPI transfers, played PWM sequences), see stub.cpp.
+  --------------------------------------------------------------------*/
+
+#ifndef NEO_STUB_PARTICLE_H
+#define NEO_STUB_PARTICLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef PLATFORM_ID
+#error "PLATFORM_ID must be defined (6, 12 or 32)"
+#endif
+
+#if PLATFORM_ID == 12
+#define HAL_PLATFORM_NRF52840 1
+#else
+#define HAL_PLATFORM_NRF52840 0
+#endif
+
+#define SYSTEM_VERSION                  0x05080000
+#define SYSTEM_VERSION_ALPHA(a,b,c,d)   (((a) << 24) | ((b) << 16) | ((c) << 8))
+
+typedef uint8_t byte;
+typedef uint16_t pin_t;
+
+#define PIN_INVALID 0xFF
+enum PinMode { INPUT, OUTPUT };
+#define LOW  0
+#define HIGH 1
+
+void pinMode(pin_t pin, PinMode mode);
+PinMode getPinMode(pin_t pin);
+void digitalWrite(pin_t pin, uint8_t value);
+int32_t digitalRead(pin_t pin);
+uint32_t micros(void);
+uint32_t millis(void);
+void delayMicroseconds(uint32_t us);
+
+struct Logger {
+  void error(const char *fmt, ...);
+};
+extern Logger Log;
+
+// Thread switching is off inside the block
+struct SingleThreadedSection {
+  bool done;
+  SingleThreadedSection();
+  ~SingleThreadedSection();
+  bool go() { bool first = !done; done = true; return first; }
+};
+#define SINGLE_THREADED_BLOCK() for (SingleThreadedSection __cs; __cs.go(); )
+extern int stubSingleThreaded; // > 0 inside SINGLE_THREADED_BLOCK()
+
+// ---- SPI ----
+#define MSBFIRST 1
+#define SPI_MODE0 0
+#define SPI_MODE_MASTER 0
+#define HAL_PLATFORM_SPI_NUM 2
+#define HAL_SPI_INTERFACE1 0
+#define HAL_SPI_INTERFACE2 1
+#define HAL_SPI_CONFIG_VERSION 1
+#define HAL_SPI_CONFIG_FLAG_MOSI_ONLY 1
+#define SCK   13
+#define MISO  12
+#define SCK1  4
+#define MISO1 3
+struct hal_spi_config_t { uint32_t size, version, flags; };
+void hal_spi_begin_ext(int spi, int mode, pin_t ss, hal_spi_config_t *config);
+
+typedef void (*wiring_spi_dma_transfercomplete_callback_t)(void);
+
+class SPIClass {
+ public:
+  explicit SPIClass(int interface) : interface_(interface) {}
+  int interface() { return interface_; }
+  void begin(pin_t ss = PIN_INVALID);
+  void end();
+  void setBitOrder(uint8_t order);
+  void setDataMode(uint8_t mode);
+  void setClockSpeed(unsigned clock);
+  void beginTransaction();
+  void endTransaction();
+  // Blocking without a callback; the callback runs at the end otherwise
+  void transfer(const void *tx, void *rx, size_t length,
+                wiring_spi_dma_transfercomplete_callback_t user_callback);
+ private:
+  int interface_;
+};
+extern SPIClass SPI, SPI1;
+
+// ---- Cortex-M core ----
+extern uint32_t SystemCoreClock;
+void __disable_irq(void);
+void __enable_irq(void);
+
+// Cycle counter that advances by stubCyclesPerRead on every read, so busy
+// waits on it end.  stubOnCycleRead (if set) may move it further, e.g. to
+// inject an interrupt.
+struct StubCycleCounter {
+  uint32_t now;
+  operator uint32_t();
+};
+extern uint32_t stubCyclesPerRead;
+extern void (*stubOnCycleRead)(uint32_t &now);
+
+struct DWT_Type { uint32_t CTRL; StubCycleCounter CYCCNT; };
+struct CoreDebug_Type { uint32_t DEMCR; };
+extern DWT_Type *DWT;
+extern CoreDebug_Type *CoreDebug;
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+
+// GPIO output register: records the cycle count and level of each write
+struct StubPinReg {
+  uint8_t level; // Level a write to this register drives
+  void operator=(uint32_t bits) volatile;
+  void operator|=(uint32_t bits) volatile { *this = bits; }
+};
+
+#if (PLATFORM_ID == 6)
+struct GPIO_TypeDef { StubPinReg BSRRL, BSRRH; };
+struct STM32_Pin_Info { GPIO_TypeDef *gpio_peripheral; uint16_t gpio_pin; };
+STM32_Pin_Info *hal_pin_map(void);
+#endif
+
+#endif // NEO_STUB_PARTICLE_H
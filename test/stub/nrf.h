@@ -0,0 +1,58 @@
+// Host stand-in for the nRF52840 registers used by the NeoPixel library,
+// see Particle.h
+#ifndef NEO_STUB_NRF_H
+#define NEO_STUB_NRF_H
+
+#include "Particle.h"
+
+struct NRF_PWM_Type;
+
+// Event register: reading it while a sequence is playing lets the stub
+// PWM play on until the event fires
+struct StubPwmEvent {
+  NRF_PWM_Type *dev;
+  uint32_t value;
+  operator uint32_t() volatile;
+  void operator=(uint32_t v) volatile { value = v; }
+};
+
+// Task register: writing 1 triggers the task
+struct StubPwmTask {
+  NRF_PWM_Type *dev;
+  uint8_t task;
+  void operator=(uint32_t v) volatile;
+};
+
+struct NRF_PWM_Type {
+  uint32_t ENABLE, MODE, PRESCALER, COUNTERTOP, LOOP, DECODER;
+  struct { uint32_t PTR, CNT, REFRESH, ENDDELAY; } SEQ[2];
+  struct { uint32_t OUT[4]; } PSEL;
+  StubPwmEvent EVENTS_SEQEND[2], EVENTS_LOOPSDONE, EVENTS_STOPPED;
+  StubPwmTask TASKS_SEQSTART[2], TASKS_STOP;
+  // Playback state
+  bool running;
+  uint8_t seq;        // Sequence playing next
+  uint32_t loopsLeft; // SEQ[0]/SEQ[1] rounds left with LOOP enabled
+};
+extern NRF_PWM_Type *NRF_PWM0, *NRF_PWM1, *NRF_PWM2;
+
+struct NRF_GPIO_Type { StubPinReg OUTSET, OUTCLR; };
+extern NRF_GPIO_Type *NRF_GPIO;
+
+#define PWM_PSEL_OUT_CONNECT_Msk        (1UL << 31)
+#define PWM_MODE_UPDOWN_Up              0
+#define PWM_MODE_UPDOWN_Pos             0
+#define PWM_PRESCALER_PRESCALER_DIV_1   0
+#define PWM_PRESCALER_PRESCALER_Pos     0
+#define PWM_COUNTERTOP_COUNTERTOP_Pos   0
+#define PWM_LOOP_CNT_Disabled           0
+#define PWM_LOOP_CNT_Pos                0
+#define PWM_DECODER_LOAD_Common         0
+#define PWM_DECODER_LOAD_Pos            0
+#define PWM_DECODER_MODE_RefreshCount   0
+#define PWM_DECODER_MODE_Pos            8
+#define PWM_SEQ_PTR_PTR_Pos             0
+#define PWM_SEQ_CNT_CNT_Pos             0
+#define PWM_SEQ_CNT_CNT_Msk             0x7FFFUL // 15 bits
+
+#endif // NEO_STUB_NRF_H
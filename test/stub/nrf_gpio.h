@@ -0,0 +1,6 @@
+#ifndef NEO_STUB_NRF_GPIO_H
+#define NEO_STUB_NRF_GPIO_H
+
+#define NRF_GPIO_PIN_MAP(port, pin) (((port) << 5) | ((pin) & 0x1F))
+
+#endif // NEO_STUB_NRF_GPIO_H
@@ -0,0 +1,9 @@
+#ifndef NEO_STUB_PINMAP_IMPL_H
+#define NEO_STUB_PINMAP_IMPL_H
+
+#include <stdint.h>
+
+struct NRF5x_Pin_Info { uint8_t gpio_port; uint8_t gpio_pin; };
+NRF5x_Pin_Info *hal_pin_map(void);
+
+#endif // NEO_STUB_PINMAP_IMPL_H
@@ -0,0 +1,316 @@
+/*--------------------------------------------------------------------
+  Host stand-in for Device OS, see Particle.h.  Also holds main(),
+  which runs the tests, or the benchmarks in bench.cpp (NEO_BENCH).
+  --------------------------------------------------------------------*/
+
+#include "neo_test.h"
+#include <malloc.h>
+#if HAL_PLATFORM_NRF52840
+#include "nrf.h"
+#include "pinmap_impl.h"
+#endif
+
+std::vector<StubEdge> stubEdges;
+std::vector<uint8_t> stubSpiOut;
+std::vector<StubSpiTransfer> stubSpiTransfers;
+std::vector<uint16_t> stubPwmOut;
+uint32_t stubAllocs;
+bool stubPwmBusy;
+int stubSingleThreaded;
+
+// ---- Allocation count (the library is linked with --wrap=malloc,realloc) ----
+extern "C" void *__real_malloc(size_t size);
+extern "C" void *__real_realloc(void *p, size_t size);
+extern "C" void *__wrap_malloc(size_t size) {
+  stubAllocs++;
+  return __real_malloc(size);
+}
+extern "C" void *__wrap_realloc(void *p, size_t size) {
+  stubAllocs++;
+  return __real_realloc(p, size);
+}
+
+// ---- Core ----
+#if HAL_PLATFORM_NRF52840
+uint32_t SystemCoreClock = 64000000;
+#else
+uint32_t SystemCoreClock = 120000000;
+#endif
+uint32_t stubCyclesPerRead = 1;
+void (*stubOnCycleRead)(uint32_t &now);
+
+static DWT_Type stubDwt;
+static CoreDebug_Type stubCoreDebug;
+DWT_Type *DWT = &stubDwt;
+CoreDebug_Type *CoreDebug = &stubCoreDebug;
+
+StubCycleCounter::operator uint32_t() {
+  now += stubCyclesPerRead;
+  if (stubOnCycleRead) stubOnCycleRead(now);
+  return now;
+}
+
+void __disable_irq(void) {}
+void __enable_irq(void) {}
+
+void StubPinReg::operator=(uint32_t) volatile {
+  stubEdges.push_back({ stubDwt.CYCCNT.now, level });
+}
+
+uint32_t micros(void) {
+  stubDwt.CYCCNT.now += 10 * (SystemCoreClock / 1000000UL);
+  return stubDwt.CYCCNT.now / (SystemCoreClock / 1000000UL);
+}
+uint32_t millis(void) { return micros() / 1000; }
+void delayMicroseconds(uint32_t us) {
+  stubDwt.CYCCNT.now += us * (SystemCoreClock / 1000000UL);
+}
+
+void pinMode(pin_t, PinMode) {}
+PinMode getPinMode(pin_t) { return INPUT; }
+void digitalWrite(pin_t, uint8_t) {}
+int32_t digitalRead(pin_t) { return 0; }
+
+Logger Log;
+void Logger::error(const char *, ...) {}
+
+SingleThreadedSection::SingleThreadedSection() : done(false) { stubSingleThreaded++; }
+SingleThreadedSection::~SingleThreadedSection() { stubSingleThreaded--; }
+
+// ---- SPI ----
+SPIClass SPI(HAL_SPI_INTERFACE1), SPI1(HAL_SPI_INTERFACE2);
+void hal_spi_begin_ext(int, int, pin_t, hal_spi_config_t *) {}
+void SPIClass::begin(pin_t) {}
+void SPIClass::end() {}
+void SPIClass::setBitOrder(uint8_t) {}
+void SPIClass::setDataMode(uint8_t) {}
+void SPIClass::setClockSpeed(unsigned) {}
+void SPIClass::beginTransaction() {}
+void SPIClass::endTransaction() {}
+void SPIClass::transfer(const void *tx, void *, size_t length,
+                        wiring_spi_dma_transfercomplete_callback_t user_callback) {
+  const uint8_t *p = (const uint8_t *)tx;
+  stubSpiOut.insert(stubSpiOut.end(), p, p + length);
+  stubSpiTransfers.push_back({ p, length, user_callback != NULL, stubSingleThreaded > 0 });
+  if (user_callback) user_callback();
+}
+
+// ---- Pins ----
+#if (PLATFORM_ID == 6)
+static GPIO_TypeDef stubGpio = { { 1 }, { 0 } };
+STM32_Pin_Info *hal_pin_map(void) {
+  static STM32_Pin_Info map[32];
+  for (int i = 0; i < 32; i++) map[i] = { &stubGpio, (uint16_t)(1 << (i & 15)) };
+  return map;
+}
+#endif
+
+#if HAL_PLATFORM_NRF52840
+static NRF_GPIO_Type stubNrfGpio = { { 1 }, { 0 } };
+NRF_GPIO_Type *NRF_GPIO = &stubNrfGpio;
+
+NRF5x_Pin_Info *hal_pin_map(void) {
+  static NRF5x_Pin_Info map[32];
+  for (int i = 0; i < 32; i++) map[i] = { 0, (uint8_t)i };
+  return map;
+}
+
+// ---- nRF52 PWM: plays a sequence when the code waits for it ----
+static void pwmPlayNext(NRF_PWM_Type *dev) {
+  uint8_t s = dev->seq;
+  const uint16_t *p = (const uint16_t *)(uintptr_t)dev->SEQ[s].PTR;
+  uint32_t cnt = dev->SEQ[s].CNT & PWM_SEQ_CNT_CNT_Msk; // What the register holds
+  stubPwmOut.insert(stubPwmOut.end(), p, p + cnt);
+  dev->EVENTS_SEQEND[s].value = 1;
+  if (dev->LOOP == 0) {
+    dev->running = false;
+    return;
+  }
+  if (s == 1 && --dev->loopsLeft == 0) {
+    dev->EVENTS_LOOPSDONE.value = 1;
+    dev->running = false;
+  }
+  dev->seq = s ^ 1;
+}
+
+StubPwmEvent::operator uint32_t() volatile {
+  if (value == 0 && dev->running) pwmPlayNext(dev);
+  return value;
+}
+
+void StubPwmTask::operator=(uint32_t v) volatile {
+  if (!v) return;
+  if (task == 2) { // STOP
+    dev->running = false;
+    dev->EVENTS_STOPPED.value = 1;
+    return;
+  }
+  dev->running = true;
+  dev->seq = task;
+  dev->loopsLeft = dev->LOOP;
+}
+
+static NRF_PWM_Type stubPwm[3];
+NRF_PWM_Type *NRF_PWM0 = &stubPwm[0], *NRF_PWM1 = &stubPwm[1], *NRF_PWM2 = &stubPwm[2];
+
+static void pwmInit(void) {
+  for (NRF_PWM_Type &d : stubPwm) {
+    memset((void *)&d, 0, sizeof(d));
+    for (int i = 0; i < 4; i++) d.PSEL.OUT[i] = 0xFFFFFFFFUL;
+    d.ENABLE = stubPwmBusy ? 1 : 0;
+    d.EVENTS_SEQEND[0].dev = d.EVENTS_SEQEND[1].dev = &d;
+    d.EVENTS_LOOPSDONE.dev = d.EVENTS_STOPPED.dev = &d;
+    d.TASKS_SEQSTART[0] = { &d, 0 };
+    d.TASKS_SEQSTART[1] = { &d, 1 };
+    d.TASKS_STOP = { &d, 2 };
+  }
+}
+#endif
+
+void stubReset(void) {
+  stubEdges.clear();
+  stubSpiOut.clear();
+  stubSpiTransfers.clear();
+  stubPwmOut.clear();
+  stubAllocs = 0;
+  stubOnCycleRead = NULL;
+  stubCyclesPerRead = 1;
+#if HAL_PLATFORM_NRF52840
+  pwmInit();
+#endif
+}
+
+// ---- Decoders ----
+std::vector<uint8_t> stubDecodeEdges(uint32_t thresholdCycles, std::vector<uint32_t> *starts) {
+  std::vector<uint8_t> out;
+  uint32_t acc = 0, bits = 0, rise = 0;
+  bool high = false;
+  for (const StubEdge &e : stubEdges) {
+    if (e.level && !high) {
+      rise = e.cycle;
+      high = true;
+      if (starts) starts->push_back(rise);
+    } else if (!e.level && high) {
+      high = false;
+      acc = (acc << 1) | ((e.cycle - rise) >= thresholdCycles);
+      if (++bits == 8) {
+        out.push_back(acc);
+        acc = bits = 0;
+      }
+    }
+  }
+  return out;
+}
+
+std::vector<uint8_t> stubDecodePwm(void) {
+  std::vector<uint8_t> out;
+  uint32_t acc = 0, bits = 0;
+  uint16_t t1h = 0;
+  for (uint16_t v : stubPwmOut) { // The longer of the two compare values is a 1
+    if ((v & 0x7FFF) > t1h) t1h = v & 0x7FFF;
+  }
+  for (uint16_t v : stubPwmOut) {
+    if ((v & 0x7FFF) == 0) break;
+    acc = (acc << 1) | ((v & 0x7FFF) == t1h);
+    if (++bits == 8) {
+      out.push_back(acc);
+      acc = bits = 0;
+    }
+  }
+  return out;
+}
+
+std::vector<uint8_t> stubDecodeSpi(void) {
+  std::vector<uint8_t> out;
+  std::vector<uint8_t> bits;
+  for (uint8_t b : stubSpiOut) {
+    for (int k = 7; k >= 0; k--) bits.push_back((b >> k) & 1);
+  }
+  size_t i = 0;
+  uint32_t acc = 0, n = 0;
+  while (i + 2 < bits.size()) {
+    if (bits[i] == 0) { // Reset (or padding) between frames
+      i++;
+      continue;
+    }
+    acc = (acc << 1) | bits[i + 1];
+    i += 3;
+    if (++n == 8) {
+      out.push_back(acc);
+      acc = n = 0;
+    }
+  }
+  return out;
+}
+
+// ---- Test data ----
+static uint32_t testSeed = 12345;
+
+uint8_t testRandomByte(void) {
+  testSeed = testSeed * 1103515245 + 12345;
+  return testSeed >> 23;
+}
+
+std::vector<uint8_t> testRandomFrame(size_t bytes) {
+  std::vector<uint8_t> v(bytes);
+  for (uint8_t &b : v) b = testRandomByte();
+  return v;
+}
+
+std::vector<uint8_t> testRandomize(Adafruit_NeoPixel &strip) {
+  uint8_t *p = strip.getPixels();
+  uint32_t bytes = strip.numPixels() * NEO_PIXEL_BYTES(strip.getType());
+  for (uint32_t i = 0; i < bytes; i++) p[i] = testRandomByte();
+  return std::vector<uint8_t>(p, p + bytes);
+}
+
+bool testIsColorByte(const Adafruit_NeoPixel &strip, uint32_t i) {
+  return strip.getType() != APA102 || (i & 3) != 0;
+}
+
+// ---- Runner ----
+#ifdef NEO_BENCH
+int neoBenchMain(void); // bench.cpp
+#endif
+
+struct NeoTestEntry { const char *name; NeoTestFn fn; };
+static std::vector<NeoTestEntry> &neoTests(void) {
+  static std::vector<NeoTestEntry> tests;
+  return tests;
+}
+
+NeoTestReg::NeoTestReg(const char *name, NeoTestFn fn) {
+  neoTests().push_back({ name, fn });
+}
+
+int neoTestFailures;
+
+void neoTestFail(const char *file, int line, const char *expr, long long a, long long b) {
+  printf("%s:%d: CHECK(%s) failed", file, line, expr);
+  if (a != b) printf(" (%lld vs %lld)", a, b);
+  printf("\n");
+  neoTestFailures++;
+}
+
+int main(void) {
+#if HAL_PLATFORM_NRF52840
+  mallopt(M_MMAP_MAX, 0); // Keep big buffers in the heap, below 4GB (PWM PTR)
+#endif
+#ifdef NEO_BENCH
+  stubReset();
+  return neoBenchMain();
+#endif
+  int failed = 0;
+  for (const NeoTestEntry &t : neoTests()) {
+    int before = neoTestFailures;
+    stubPwmBusy = false;
+    stubReset();
+    t.fn();
+    if (neoTestFailures != before) {
+      printf("FAIL %s\n", t.name);
+      failed++;
+    }
+  }
+  printf("platform %d: %d tests, %d failed\n", PLATFORM_ID, (int)neoTests().size(), failed);
+  return failed ? 1 : 0;
+}
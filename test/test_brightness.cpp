@@ -0,0 +1,24 @@
+// setBrightness() on 16-bit pixels (user-037)
+#include "neo_test.h"
+
+NEO_TEST(brightness16BitRoundTrip) {
+  Adafruit_NeoPixel strip(2, NEO_TEST_OUT, WS2816);
+  strip.setPixelColor(0, 255, 255, 255);
+  strip.setPixelColor(1, 0, 128, 1);
+  const uint8_t *p = strip.getPixels();
+  CHECK_EQ(p[0] << 8 | p[1], 0xFFFF);
+
+  strip.setBrightness(128);
+  CHECK_EQ(p[0] << 8 | p[1], (0xFFFF * 129) >> 8);
+  // Back to full: 0x80FF * (65535 / 128) / 256 is over 0xFFFF
+  strip.setBrightness(255);
+  for (int i = 0; i < 6; i += 2) CHECK_EQ(p[i] << 8 | p[i + 1], 0xFFFF);
+  CHECK((p[6] << 8 | p[7]) >= 0x8080 - 0x200); // G of pixel 1
+
+  // Dimming all the way and back never wraps either
+  for (int b = 254; b > 0; b -= 7) {
+    strip.setBrightness(b);
+    strip.setBrightness(255);
+    CHECK(p[0] >= 0x80);
+  }
+}
@@ -0,0 +1,58 @@
+// Word-at-a-time scale, blend and saturating add (user-046) against the
+// per-byte math
+#include "neo_test.h"
+
+// 7 RGB pixels leave a byte tail after the words; APA102 keeps its
+// brightness bytes
+static const uint8_t byteTypes[] = { WS2812B, SK6812RGBW, APA102 };
+
+NEO_TEST(bulkScaleBlendAdd) {
+  for (uint8_t type : byteTypes) {
+    Adafruit_NeoPixel strip(7, NEO_TEST_OUT, type);
+    uint32_t bytes = 7 * NEO_PIXEL_BYTES(type);
+    const uint8_t *p = strip.getPixels();
+    for (int amount = 0; amount < 256; amount += 15) {
+      std::vector<uint8_t> a = testRandomize(strip);
+      strip.fadeToBlack(amount);
+      for (uint32_t i = 0; i < bytes; i++) {
+        CHECK_EQ(p[i], testIsColorByte(strip, i) ? a[i] * (256 - amount) >> 8 : a[i]);
+      }
+
+      uint32_t t = amount + (amount >> 7);
+      a = testRandomize(strip);
+      std::vector<uint8_t> b = testRandomFrame(bytes);
+      strip.blend(b.data(), amount);
+      for (uint32_t i = 0; i < bytes; i++) {
+        CHECK_EQ(p[i], testIsColorByte(strip, i) ? (a[i] * (256 - t) + b[i] * t) >> 8 : a[i]);
+      }
+
+      a = testRandomize(strip);
+      strip.addColors(b.data());
+      for (uint32_t i = 0; i < bytes; i++) {
+        CHECK_EQ(p[i], testIsColorByte(strip, i) ? std::min(a[i] + b[i], 255) : a[i]);
+      }
+    }
+  }
+}
+
+NEO_TEST(bulkPairs16) {
+  Adafruit_NeoPixel strip(3, NEO_TEST_OUT, WS2816);
+  const uint8_t *p = strip.getPixels();
+  std::vector<uint8_t> a = testRandomize(strip), b = testRandomFrame(18);
+  strip.fadeToBlack(100);
+  for (int i = 0; i < 18; i += 2) {
+    CHECK_EQ(p[i] << 8 | p[i + 1], (uint32_t)(a[i] << 8 | a[i + 1]) * 156 >> 8);
+  }
+  a = testRandomize(strip);
+  strip.blend(b.data(), 64);
+  for (int i = 0; i < 18; i += 2) {
+    uint32_t va = a[i] << 8 | a[i + 1], vb = b[i] << 8 | b[i + 1];
+    CHECK_EQ(p[i] << 8 | p[i + 1], (va * 192 + vb * 64) >> 8);
+  }
+  a = testRandomize(strip);
+  strip.addColors(b.data());
+  for (int i = 0; i < 18; i += 2) {
+    uint32_t va = a[i] << 8 | a[i + 1], vb = b[i] << 8 | b[i + 1];
+    CHECK_EQ(p[i] << 8 | p[i + 1], std::min(va + vb, 0xFFFFu));
+  }
+}
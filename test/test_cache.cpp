@@ -0,0 +1,69 @@
+// Frame cache entries are sent whole, so only frames that fit one PWM
+// sequence or one SPI transfer are cached (user-045)
+#include "neo_test.h"
+
+#if (PLATFORM_ID == 32) || HAL_PLATFORM_NRF52840
+static void fillStrip(Adafruit_NeoPixel &strip, std::vector<uint8_t> &expect) {
+  expect.clear();
+  for (uint32_t i = 0; i < strip.numPixels(); i++) {
+    uint32_t c = (i * 2654435761u) >> 8;
+    strip.setPixelColor(i, c);
+    expect.push_back(c >> 8);  // G
+    expect.push_back(c >> 16); // R
+    expect.push_back(c);       // B
+  }
+}
+
+static std::vector<uint8_t> decode(void) {
+#if HAL_PLATFORM_NRF52840
+  return stubDecodePwm();
+#else
+  return stubDecodeSpi();
+#endif
+}
+
+// Shows the strip twice and checks both frames arrive complete
+static void showTwice(Adafruit_NeoPixel &strip) {
+  std::vector<uint8_t> expect;
+  fillStrip(strip, expect);
+  for (int i = 0; i < 2; i++) {
+    stubReset();
+    strip.show();
+    std::vector<uint8_t> out = decode();
+    CHECK_EQ(out.size(), expect.size());
+    CHECK(out == expect);
+  }
+}
+
+NEO_TEST(cacheFitsOneTransfer) {
+#if HAL_PLATFORM_NRF52840
+  Adafruit_NeoPixel strip(1000, 2, WS2812B); // 24002 compare values
+#else
+  Adafruit_NeoPixel strip(1500, SPI, WS2812B); // 13500 SPI bytes
+#endif
+  strip.begin();
+  CHECK(strip.setFrameCache(100000));
+  showTwice(strip);
+  CHECK_EQ(strip.getCacheMisses(), 1u);
+  CHECK_EQ(strip.getCacheHits(), 1u);
+#if (PLATFORM_ID == 32)
+  CHECK_EQ(stubSpiTransfers.size(), 3u); // Reset, frame, reset
+#endif
+}
+
+NEO_TEST(cacheTooLongIsChunked) {
+#if HAL_PLATFORM_NRF52840
+  Adafruit_NeoPixel strip(1400, 2, WS2812B); // 33602 compare values
+#else
+  Adafruit_NeoPixel strip(7300, SPI, WS2812B); // 65700 SPI bytes
+#endif
+  strip.begin();
+  CHECK(strip.setFrameCache(200000));
+  showTwice(strip);
+  CHECK_EQ(strip.getCacheMisses(), 0u);
+  CHECK_EQ(strip.getCacheHits(), 0u);
+#if (PLATFORM_ID == 32)
+  for (const StubSpiTransfer &t : stubSpiTransfers) CHECK(t.bytes <= 0xFFFC);
+#endif
+}
+#endif
@@ -0,0 +1,81 @@
+// Long frames are sent in chunks whatever buffer they use (user-034)
+#include "neo_test.h"
+
+#if (PLATFORM_ID == 32) || HAL_PLATFORM_NRF52840
+// 4500 wire bytes: over the 15-bit SEQ[n].CNT of nRF52 as one sequence
+#if (PLATFORM_ID == 32)
+static StaticNeoPixel<1500, WS2812B> longStrip(SPI);
+#else
+static StaticNeoPixel<1500, WS2812B> longStrip(2);
+#endif
+
+// The fixed encode buffer holds two chunks, not the whole frame
+static_assert(sizeof(longStrip) < 1500 * 3 + NEO_ENCODE_BYTES(2 * NEO_CHUNK_BYTES) + 256,
+              "encode buffer grows with the strip");
+
+static std::vector<uint8_t> fillLong(void) {
+  std::vector<uint8_t> expect;
+  for (uint32_t i = 0; i < 1500; i++) {
+    uint32_t c = (i * 2654435761u) >> 8;
+    longStrip.setPixelColor(i, c);
+    expect.push_back(c >> 8);  // G
+    expect.push_back(c >> 16); // R
+    expect.push_back(c);       // B
+  }
+  return expect;
+}
+
+static void checkLong(const std::vector<uint8_t> &out, const std::vector<uint8_t> &expect) {
+  CHECK_EQ(out.size(), expect.size());
+  size_t bad = 0;
+  for (size_t i = 0; i < out.size() && i < expect.size(); i++) bad += out[i] != expect[i];
+  CHECK_EQ(bad, 0u);
+}
+#endif
+
+#if HAL_PLATFORM_NRF52840
+NEO_TEST(chunkStaticPwm) {
+  longStrip.begin();
+  std::vector<uint8_t> expect = fillLong();
+  stubReset();
+  longStrip.show();
+  CHECK_EQ(stubAllocs, 0u);
+  checkLong(stubDecodePwm(), expect);
+}
+#endif
+
+#if (PLATFORM_ID == 32)
+NEO_TEST(chunkStaticSpi) {
+  longStrip.begin();
+  std::vector<uint8_t> expect = fillLong();
+  stubReset();
+  longStrip.show();
+  CHECK_EQ(stubAllocs, 0u);
+  checkLong(stubDecodeSpi(), expect);
+  // Chunks are sent by DMA with thread switching off; nothing over 64K
+  size_t chunks = 0;
+  for (const StubSpiTransfer &t : stubSpiTransfers) {
+    CHECK(t.bytes <= 0xFFFC);
+    if (t.async) {
+      chunks++;
+      CHECK(t.singleThreaded);
+    }
+  }
+  CHECK_EQ(chunks, (1500u * 3 + 509) / 510);
+}
+
+NEO_TEST(chunkShortSpi) {
+  Adafruit_NeoPixel strip(10, SPI, WS2812B);
+  strip.begin();
+  strip.setPixelColor(9, 0x010203);
+  strip.show();
+  std::vector<uint8_t> out = stubDecodeSpi();
+  CHECK_EQ(out.size(), 30u);
+  CHECK_EQ(out[27], 0x02);
+  // Reset, frame, reset; each at least 300us at 3.125MHz
+  CHECK_EQ(stubSpiTransfers.size(), 3u);
+  CHECK_EQ(stubSpiOut.size(), 30u * 3 + 2 * 118);
+  CHECK_EQ(stubSpiOut[0], 0);
+  CHECK_EQ(stubSpiOut.back(), 0);
+}
+#endif
@@ -0,0 +1,43 @@
+// Two-frame crossfade and per-pixel alpha blend (user-047) against the
+// per-byte math
+#include "neo_test.h"
+
+NEO_TEST(crossfadeBytes) {
+  for (uint8_t type : { WS2812B, SK6812RGBW, APA102 }) {
+    Adafruit_NeoPixel strip(7, NEO_TEST_OUT, type);
+    uint32_t bpp = NEO_PIXEL_BYTES(type), bytes = 7 * bpp;
+    const uint8_t *p = strip.getPixels();
+    std::vector<uint8_t> from = testRandomFrame(bytes), to = testRandomFrame(bytes);
+    strip.blend(from.data(), to.data(), 0);
+    for (uint32_t i = 0; i < bytes; i++) CHECK_EQ(p[i], from[i]);
+    strip.blend(from.data(), to.data(), 255);
+    for (uint32_t i = 0; i < bytes; i++) CHECK_EQ(p[i], testIsColorByte(strip, i) ? to[i] : from[i]);
+
+    std::vector<uint8_t> alpha = testRandomFrame(7);
+    strip.blendAlpha(from.data(), to.data(), alpha.data());
+    for (uint32_t i = 0; i < bytes; i++) {
+      uint32_t t = alpha[i / bpp] + (alpha[i / bpp] >> 7);
+      CHECK_EQ(p[i], testIsColorByte(strip, i) ? (from[i] * (256 - t) + to[i] * t) >> 8 : from[i]);
+    }
+  }
+}
+
+NEO_TEST(crossfadeOwnBuffer) {
+  // 'from' may be the strip's own buffer
+  Adafruit_NeoPixel strip(5, NEO_TEST_OUT, WS2812B);
+  std::vector<uint8_t> a = testRandomize(strip), to = testRandomFrame(15);
+  strip.blend(strip.getPixels(), to.data(), 128);
+  for (uint32_t i = 0; i < 15; i++) CHECK_EQ(strip.getPixels()[i], (a[i] * 127 + to[i] * 129) >> 8);
+}
+
+NEO_TEST(crossfadePairs16) {
+  Adafruit_NeoPixel strip(3, NEO_TEST_OUT, WS2816);
+  const uint8_t *p = strip.getPixels();
+  std::vector<uint8_t> from = testRandomFrame(18), to = testRandomFrame(18), alpha = testRandomFrame(3);
+  strip.blendAlpha(from.data(), to.data(), alpha.data());
+  for (int i = 0; i < 18; i += 2) {
+    uint32_t t = alpha[i / 6] + (alpha[i / 6] >> 7);
+    uint32_t va = from[i] << 8 | from[i + 1], vb = to[i] << 8 | to[i + 1];
+    CHECK_EQ(p[i] << 8 | p[i + 1], (va * (256 - t) + vb * t) >> 8);
+  }
+}
@@ -0,0 +1,45 @@
+// ColorHSV() and the one-pass rainbow() fill (user-048)
+#include "neo_test.h"
+#include <math.h>
+
+// Float HSV: each channel is full within a sixth of the circle from its
+// hue, ramping to zero over the next sixth
+static float hsvChannel(float hue6, float peak) {
+  float d = fabsf(hue6 - peak);
+  if (d > 3) d = 6 - d;
+  return std::min(std::max(2 - d, 0.0f), 1.0f);
+}
+
+NEO_TEST(hsvAgainstFloat) {
+  static const uint8_t levels[] = { 0, 1, 100, 254, 255 };
+  for (uint32_t hue = 0; hue < 65536; hue += 97) {
+    for (uint8_t sat : levels) {
+      for (uint8_t val : levels) {
+        uint32_t c = Adafruit_NeoPixel::ColorHSV(hue, sat, val);
+        float h6 = hue * 6.0f / 65536;
+        for (int i = 0; i < 3; i++) {
+          float f = (hsvChannel(h6, 2 * i) * sat / 255 + (255 - sat) / 255.0f) * val;
+          int v = (c >> (16 - 8 * i)) & 0xFF;
+          CHECK(fabsf(v - f) <= 3); // Hue in 1536 steps, two truncations
+        }
+      }
+    }
+    CHECK_EQ(Adafruit_NeoPixel::ColorHSV(hue, 255, 255, true),
+             Adafruit_NeoPixel::gamma32(Adafruit_NeoPixel::ColorHSV(hue)));
+  }
+}
+
+NEO_TEST(hsvRainbow) {
+  for (uint8_t type : { WS2812B, SK6812RGBW }) {
+    for (int reps : { 1, 3, -1 }) {
+      Adafruit_NeoPixel strip(50, NEO_TEST_OUT, type);
+      strip.setPixelColor(0, 1, 2, 3, 4); // White is turned off
+      strip.rainbow(1000, reps, 200, 180);
+      uint32_t step = (uint32_t)((int64_t)reps * 0x100000000LL / 50);
+      for (uint32_t n = 0; n < 50; n++) {
+        uint16_t hue = ((1000u << 16) + n * step) >> 16;
+        CHECK_EQ(strip.getPixelColor(n), Adafruit_NeoPixel::ColorHSV(hue, 200, 180, true));
+      }
+    }
+  }
+}
@@ -0,0 +1,86 @@
+// neopixel_math.h against floating point references (user-049)
+#include "neo_test.h"
+#include "neopixel_math.h"
+#include <math.h>
+
+// Constant arguments fold at compile time
+static_assert(scale8(255, 255) == 255 && scale8(255, 0) == 0 && scale8(200, 127) == 100, "scale8");
+static_assert(scale16(65535, 65535) == 65535 && scale16(40000, 32767) == 20000, "scale16");
+static_assert(qadd8(200, 100) == 255 && qadd8(20, 30) == 50, "qadd8");
+static_assert(qsub8(20, 30) == 0 && qsub8(30, 20) == 10, "qsub8");
+static_assert(lerp8(10, 200, 0) == 10 && lerp8(10, 200, 255) == 200 && lerp8(200, 10, 255) == 10, "lerp8");
+static_assert(sin8(0) == 128 && sin8(64) == 255 && sin8(128) == 128 && sin8(192) == 1, "sin8");
+static_assert(cos8(0) == 255 && cos8(128) == 1, "cos8");
+static_assert(triwave8(0) == 0 && triwave8(127) == 254 && triwave8(128) == 254 && triwave8(255) == 0, "triwave8");
+// Half a beat at 60 bpm is 32768, 0.14% fast
+static_assert(beat16(60, 500) == 32812 && beat8(60, 1000) == 0, "beat16");
+
+static int absDiff(int a, int b) { return (a > b) ? a - b : b - a; }
+
+NEO_TEST(mathScale) {
+  int worst = 0;
+  for (int i = 0; i < 256; i++) {
+    for (int s = 0; s < 256; s++) {
+      int ref = (int)lround(i * s / 255.0);
+      worst = std::max(worst, absDiff(scale8(i, s), ref));
+      CHECK_EQ(qadd8(i, s), std::min(i + s, 255));
+      CHECK_EQ(qsub8(i, s), std::max(i - s, 0));
+    }
+  }
+  CHECK(worst <= 1);
+
+  worst = 0;
+  for (uint32_t i = 0; i < 65536; i += 251) {
+    for (uint32_t s = 0; s < 65536; s += 257) {
+      int ref = (int)lround(i * (double)s / 65535.0);
+      worst = std::max(worst, absDiff(scale16(i, s), ref));
+    }
+  }
+  CHECK(worst <= 1);
+}
+
+NEO_TEST(mathLerp) {
+  int worst = 0;
+  for (int a = 0; a < 256; a++) {
+    for (int b = 0; b < 256; b++) {
+      for (int f = 0; f < 256; f += 5) {
+        int ref = (int)lround(a + (b - a) * f / 255.0);
+        worst = std::max(worst, absDiff(lerp8(a, b, f), ref));
+      }
+    }
+  }
+  CHECK(worst <= 1);
+}
+
+NEO_TEST(mathWaves) {
+  int worst = 0;
+  for (int t = 0; t < 256; t++) {
+    double s = sin(t * 2 * M_PI / 256);
+    worst = std::max(worst, absDiff(sin8(t), (int)lround(128 + 127 * s)));
+    worst = std::max(worst, absDiff(cos8(t), (int)lround(128 + 127 * cos(t * 2 * M_PI / 256))));
+    int tri = (int)lround(254 * (1 - fabs(t - 127.5) / 127.5));
+    CHECK(absDiff(triwave8(t), tri) <= 1);
+  }
+  CHECK(worst <= 1);
+}
+
+NEO_TEST(mathBeat) {
+  // Phase within 0.14% (plus rounding) of the exact bpm * ms / 60000 beats
+  for (uint32_t bpm = 1; bpm <= 240; bpm += 7) {
+    for (uint32_t ms = 0; ms <= 60000; ms += 97) {
+      double ref = bpm * (double)ms * 65536.0 / 60000.0;
+      int16_t err = (int16_t)(beat16(bpm, ms) - (uint16_t)(uint64_t)ref);
+      CHECK(fabs((double)err) <= ref * 0.0014 + 1);
+    }
+  }
+  // Past the point where the 32-bit product wraps the phase stays exact
+  for (uint32_t ms = 1000000; ms < 4000000000u; ms += 99999989) {
+    CHECK_EQ(beat16(120, ms), (uint16_t)(((uint64_t)ms * 120 * 280) >> 8));
+  }
+  // beatsin8/beattri8 stay within their range
+  for (uint32_t ms = 0; ms < 5000; ms += 3) {
+    uint8_t v = beatsin8(73, 40, 90, ms), w = beattri8(73, 40, 90, ms);
+    CHECK(v >= 40 && v <= 90);
+    CHECK(w >= 40 && w <= 90);
+  }
+}
@@ -0,0 +1,40 @@
+// Moving strips; a StaticNeoPixel's buffers can't be moved out (user-032)
+#include "neo_test.h"
+#include <type_traits>
+#include <utility>
+
+typedef StaticNeoPixel<8, WS2812B> SmallStatic;
+static_assert(!std::is_constructible<Adafruit_NeoPixel, SmallStatic&&>::value,
+              "moving out of a StaticNeoPixel must not compile");
+static_assert(!std::is_assignable<Adafruit_NeoPixel&, SmallStatic&&>::value,
+              "moving out of a StaticNeoPixel must not compile");
+static_assert(std::is_nothrow_move_constructible<Adafruit_NeoPixel>::value,
+              "strips can still be moved, e.g. in a std::vector");
+
+NEO_TEST(moveHeapStrip) {
+  Adafruit_NeoPixel a(4, NEO_TEST_OUT, WS2812B);
+  a.setPixelColor(3, 0x123456);
+  Adafruit_NeoPixel b(std::move(a));
+  CHECK_EQ(b.numPixels(), 4u);
+  CHECK_EQ(b.getPixelColor(3), 0x123456u);
+  CHECK_EQ(a.numPixels(), 0u);
+  CHECK(a.getPixels() == NULL);
+}
+
+static SmallStatic moveStatic(NEO_TEST_OUT);
+
+NEO_TEST(moveStaticThroughBase) {
+  moveStatic.setPixelColor(7, 0xABCDEF);
+  Adafruit_NeoPixel &base = moveStatic;
+  Adafruit_NeoPixel b(std::move(base));
+  // Nothing taken: the target is empty and the source still works
+  CHECK_EQ(b.numPixels(), 0u);
+  CHECK(b.getPixels() == NULL);
+  CHECK_EQ(moveStatic.numPixels(), 8u);
+  CHECK_EQ(moveStatic.getPixelColor(7), 0xABCDEFu);
+
+  Adafruit_NeoPixel c(2, NEO_TEST_OUT, WS2812B);
+  c = std::move(base);
+  CHECK_EQ(c.numPixels(), 0u);
+  CHECK_EQ(moveStatic.getPixelColor(7), 0xABCDEFu);
+}
@@ -0,0 +1,43 @@
+// Integer noise fills (user-050)
+#include "neo_test.h"
+#include <algorithm>
+
+NEO_TEST(noiseFill) {
+  Adafruit_NeoPixel strip(300, NEO_TEST_OUT, WS2812B);
+  strip.fillNoise(0, 300, 24, 5000);
+  std::vector<uint8_t> first(strip.getPixels(), strip.getPixels() + 900);
+  strip.fillNoise(0, 300, 24, 5000);
+  CHECK(std::equal(first.begin(), first.end(), strip.getPixels()));
+
+  // Gray levels (c0 black, c1 white) that span most of the range and change
+  // by about the noise step from pixel to pixel
+  int lo = 255, hi = 0, maxStep = 0;
+  for (uint32_t n = 0; n < 300; n++) {
+    uint32_t c = strip.getPixelColor(n);
+    CHECK_EQ(c & 0xFF, (c >> 8) & 0xFF);
+    int v = c & 0xFF;
+    lo = std::min(lo, v);
+    hi = std::max(hi, v);
+    if (n) maxStep = std::max(maxStep, abs(v - (int)(strip.getPixelColor(n - 1) & 0xFF)));
+  }
+  CHECK(lo < 80 && hi > 176);
+  CHECK(maxStep <= 2 * 24); // The noise slope stays under 2 levels per step
+
+  // The count is clipped at the end of the strip and nothing else is written
+  strip.clear();
+  strip.fillNoise(290, 100, 24, 5000, 3, 0x010101, 0x010101);
+  CHECK_EQ(strip.getPixelColor(289), 0u);
+  for (uint32_t n = 290; n < 300; n++) CHECK_EQ(strip.getPixelColor(n), 0x010101u);
+}
+
+NEO_TEST(noise2DSerpentine) {
+  Adafruit_NeoPixel rows(24, NEO_TEST_OUT, WS2812B), zigzag(24, NEO_TEST_OUT, WS2812B);
+  rows.fillNoise2D(6, 4, false, 40, 77, 2);
+  zigzag.fillNoise2D(6, 4, true, 40, 77, 2);
+  for (uint32_t y = 0; y < 4; y++) {
+    for (uint32_t x = 0; x < 6; x++) {
+      uint32_t z = (y & 1) ? 5 - x : x;
+      CHECK_EQ(rows.getPixelColor(y * 6 + x), zigzag.getPixelColor(y * 6 + z));
+    }
+  }
+}
@@ -0,0 +1,76 @@
+// nRF52 PWM compare values from the nibble table (user-028) and the
+// strip's timing (user-041)
+#include "neo_test.h"
+
+#if HAL_PLATFORM_NRF52840
+#include "nrf.h"
+
+NEO_TEST(pwmAllByteValues) {
+  Adafruit_NeoPixel strip(86, 2, WS2812B); // 258 bytes: every byte value
+  strip.begin();
+  uint8_t *p = strip.getPixels();
+  for (int i = 0; i < 258; i++) p[i] = i;
+  strip.show();
+
+  std::vector<uint8_t> out = stubDecodePwm();
+  CHECK_EQ(out.size(), 258u);
+  for (size_t i = 0; i < out.size(); i++) CHECK_EQ(out[i], i & 0xFF);
+
+  // 8 values per byte, each T0H or T1H, then exactly the two end values
+  CHECK_EQ(stubPwmOut.size(), 258u * 8 + 2);
+  uint16_t t0h = 0xFFFF, t1h = 0;
+  for (size_t i = 0; i < 258u * 8; i++) {
+    uint16_t v = stubPwmOut[i];
+    CHECK(v & 0x8000);
+    if (v < t0h) t0h = v;
+    if (v > t1h) t1h = v;
+  }
+  for (size_t i = 0; i < 258u * 8; i++) CHECK(stubPwmOut[i] == t0h || stubPwmOut[i] == t1h);
+  CHECK(t0h < t1h);
+  CHECK_EQ(stubPwmOut[258 * 8], 0x8000);
+  CHECK_EQ(stubPwmOut[258 * 8 + 1], 0x8000);
+}
+
+// Compare values follow the default timing of the pixel type, not only a
+// custom one: SK6812 is 300/600ns, 5 and 10 steps of the 16MHz clock
+NEO_TEST(pwmTypeTiming) {
+  stubReset();
+  Adafruit_NeoPixel strip(1, 2, SK6812RGBW);
+  strip.begin();
+  strip.setPixelColor(0, 255, 0, 255, 0);
+  strip.show();
+  CHECK_EQ(stubPwmOut.size(), 4u * 8 + 2);
+  for (size_t i = 0; i < 32; i++) {
+    CHECK_EQ(stubPwmOut[i], ((i / 8) & 1) == 0 && i < 24 ? 0x800A : 0x8005);
+  }
+}
+
+// The device is timed when it is claimed and again when the timing
+// changes; show() uses what is set
+NEO_TEST(pwmTimedOnChange) {
+  stubReset();
+  Adafruit_NeoPixel strip(1, 2, WS2812B);
+  strip.begin();
+  NRF_PWM_Type *dev = NULL;
+  for (NRF_PWM_Type *d : { NRF_PWM0, NRF_PWM1, NRF_PWM2 }) {
+    if (d->ENABLE) dev = d;
+  }
+  CHECK(dev != NULL);
+  if (dev == NULL) return;
+  CHECK_EQ(dev->COUNTERTOP, 20u); // 1250ns
+
+  NeoTiming t = { 300, 900, 1500, 80 };
+  CHECK(strip.setTiming(t));
+  CHECK_EQ(dev->COUNTERTOP, 24u);
+  strip.setPixelColor(0, 0x00FF00); // G first: one byte of 1 bits
+  strip.show();
+  CHECK_EQ(dev->COUNTERTOP, 24u);
+  for (size_t i = 0; i < 24; i++) CHECK_EQ(stubPwmOut[i], i < 8 ? 0x800E : 0x8005);
+
+  strip.resetTiming();
+  CHECK_EQ(dev->COUNTERTOP, 20u);
+  stubPwmOut.clear();
+  strip.show();
+  for (size_t i = 0; i < 24; i++) CHECK_EQ(stubPwmOut[i], i < 8 ? 0x800D : 0x8006);
+}
+#endif
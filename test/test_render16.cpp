@@ -0,0 +1,52 @@
+// 16-bit render buffer reduced to 8 bits in show() (user-036)
+#include "neo_test.h"
+
+NEO_TEST(render16Availability) {
+  Adafruit_NeoPixel strip(4, NEO_TEST_OUT, WS2812B);
+  CHECK(strip.set16BitBuffer(true));
+  CHECK(strip.set16BitBuffer(false));
+  Adafruit_NeoPixel native(4, NEO_TEST_OUT, WS2816);
+  CHECK(!native.set16BitBuffer(true));
+  Adafruit_NeoPixel indexed(4, NEO_TEST_OUT, WS2812B);
+  CHECK(indexed.setPaletteMode(4));
+  CHECK(!indexed.set16BitBuffer(true));
+}
+
+NEO_TEST(render16Rounded) {
+  Adafruit_NeoPixel strip(2, NEO_TEST_OUT, WS2812B);
+  strip.begin();
+  CHECK(strip.set16BitBuffer(true));
+  strip.setDither(NEO_DITHER_NONE);
+  strip.setPixelColor16(0, 0x127F, 0x1280, 0xFFFF);
+  strip.show();
+  const uint8_t *p = strip.getPixels(); // G, R, B
+  CHECK_EQ(p[0], 0x13);
+  CHECK_EQ(p[1], 0x12);
+  CHECK_EQ(p[2], 0xFF);
+}
+
+// Average 8-bit output of channel 0 over 'frames' shows, times 256
+static uint32_t averageOut(Adafruit_NeoPixel &strip, uint32_t frames) {
+  uint32_t sum = 0;
+  for (uint32_t f = 0; f < frames; f++) {
+    strip.show();
+    sum += strip.getPixels()[0];
+  }
+  return sum * 256 / frames;
+}
+
+NEO_TEST(render16Dithered) {
+  Adafruit_NeoPixel strip(2, NEO_TEST_OUT, WS2812B);
+  strip.begin();
+  CHECK(strip.set16BitBuffer(true));
+  // Error diffusion carries the remainder, so the average is exact
+  strip.setPixelColor16(0, 0, 0x1240, 0);
+  CHECK_EQ(averageOut(strip, 256), 0x1240);
+  strip.setPixelColor16(0, 0, 0x00C0, 0);
+  CHECK_EQ(averageOut(strip, 256), 0x00C0);
+  // Ordered dither repeats every 8 frames, to 1/8 of a step
+  strip.setDither(NEO_DITHER_ORDERED);
+  strip.setPixelColor16(0, 0, 0x1240, 0);
+  uint32_t avg = averageOut(strip, 8);
+  CHECK(avg >= 0x1240 - 0x20 && avg <= 0x1240 + 0x20);
+}
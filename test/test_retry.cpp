@@ -0,0 +1,107 @@
+// Retry policy of the nRF52 DWT fallback (user-029)
+#include "neo_test.h"
+
+// Frame of 1000 cycles: attempts up to 1249 cycles count as sent
+static_assert(neoRetryAction(1000, 1000, 1000, 0, 3, 0) == NEO_RETRY_DONE, "on time");
+static_assert(neoRetryAction(1249, 1000, 1249, 0, 3, 0) == NEO_RETRY_DONE, "under 25% late");
+static_assert(neoRetryAction(1250, 1000, 1250, 0, 3, 0) == NEO_RETRY_AGAIN, "25% late");
+
+NEO_TEST(retryLimits) {
+  // Out of retries
+  CHECK_EQ(neoRetryAction(2000, 1000, 9000, 2, 3, 0), NEO_RETRY_AGAIN);
+  CHECK_EQ(neoRetryAction(2000, 1000, 9000, 3, 3, 0), NEO_RETRY_GIVE_UP);
+  CHECK_EQ(neoRetryAction(2000, 1000, 9000, 0, 0, 0), NEO_RETRY_GIVE_UP);
+  CHECK_EQ(neoRetryAction(2000, 1000, 9000, 254, NEO_RETRY_UNLIMITED, 0), NEO_RETRY_AGAIN);
+
+  // Out of time (budget 0 = no limit)
+  CHECK_EQ(neoRetryAction(2000, 1000, 4999, 1, 10, 5000), NEO_RETRY_AGAIN);
+  CHECK_EQ(neoRetryAction(2000, 1000, 5000, 1, 10, 5000), NEO_RETRY_GIVE_UP);
+  CHECK_EQ(neoRetryAction(2000, 1000, 0xFFFFFFFF, 1, 10, 0), NEO_RETRY_AGAIN);
+
+  // A late attempt that made it in time is still done
+  CHECK_EQ(neoRetryAction(1100, 1000, 99999, 9, 0, 1), NEO_RETRY_DONE);
+}
+
+// Replays a pattern of interruptions (extra cycles per attempt) through
+// the policy like show() does; returns the retries, -1 on give up.
+static int replay(const uint32_t *stalls, int count, uint8_t maxRetries, uint32_t budget) {
+  const uint32_t frame = 1000, gap = 300;
+  uint32_t elapsed = 0;
+  for (int retries = 0; ; retries++) {
+    uint32_t attempt = frame + (retries < count ? stalls[retries] : 0);
+    elapsed += attempt;
+    uint8_t action = neoRetryAction(attempt, frame, elapsed, retries, maxRetries, budget);
+    if (action == NEO_RETRY_DONE) return retries;
+    if (action == NEO_RETRY_GIVE_UP) return -1;
+    elapsed += gap;
+  }
+}
+
+NEO_TEST(retryPattern) {
+  const uint32_t burst[] = { 600, 400, 250, 249 }; // Three interruptions, then short ones
+  CHECK_EQ(replay(burst, 4, 3, 0), 3);
+  CHECK_EQ(replay(burst, 4, 2, 0), -1);
+  CHECK_EQ(replay(burst, 4, NEO_RETRY_UNLIMITED, 0), 3);
+  // Attempts take 1600 + 300 + 1400 + 300 + 1250 cycles before the fourth
+  CHECK_EQ(replay(burst, 4, NEO_RETRY_UNLIMITED, 4850), -1);
+  CHECK_EQ(replay(burst, 4, NEO_RETRY_UNLIMITED, 6000), 3);
+
+  const uint32_t quiet[] = { 0 };
+  CHECK_EQ(replay(quiet, 1, 0, 1), 0);
+}
+
+#if HAL_PLATFORM_NRF52840
+// End to end: with all PWM devices taken show() bit-bangs with DWT, and
+// a stall in the middle of the first 'stallAttempts' frames makes it retry.
+static uint32_t stallAttempts, stallEdges;
+static void stallOnce(uint32_t &now) {
+  // 2 edges per bit, 8 bits per byte, 3 bytes per pixel, 4 pixels
+  const uint32_t frameEdges = 4 * 3 * 8 * 2;
+  uint32_t attempt = stubEdges.size() / frameEdges;
+  if (attempt < stallAttempts && stubEdges.size() == attempt * frameEdges + 10 &&
+      stallEdges != stubEdges.size()) {
+    stallEdges = stubEdges.size();
+    now += 100000; // A long SoftDevice interrupt
+  }
+}
+
+static Adafruit_NeoPixel retryStrip(4, 2, WS2812B);
+
+static void retryShow(uint32_t stalls) {
+  stubReset();
+  stallAttempts = stalls;
+  stallEdges = 0;
+  stubOnCycleRead = stallOnce;
+  retryStrip.setPixelColor(0, 0x123456);
+  retryStrip.setPixelColor(3, 0xABCDEF);
+  retryStrip.show();
+  stubOnCycleRead = NULL;
+}
+
+NEO_TEST(retryDwtFallback) {
+  stubPwmBusy = true;
+  stubReset();
+  retryStrip.begin();
+
+  retryShow(0);
+  CHECK_EQ(retryStrip.getRetryCount(), 0);
+  std::vector<uint8_t> out = stubDecodeEdges(SystemCoreClock / 1000000UL / 2);
+  CHECK_EQ(out.size(), 12u);
+  CHECK_EQ(out[0], 0x34); // GRB
+  CHECK_EQ(out[1], 0x12);
+  CHECK_EQ(out[11], 0xEF);
+
+  retryShow(2);
+  CHECK_EQ(retryStrip.getRetryCount(), 2);
+  CHECK_EQ(retryStrip.getGiveUpCount(), 0u);
+  CHECK_EQ(stubEdges.size(), 3u * 4 * 3 * 8 * 2);
+
+  retryStrip.setRetryPolicy(1);
+  retryShow(2);
+  CHECK_EQ(retryStrip.getRetryCount(), 1);
+  CHECK_EQ(retryStrip.getGiveUpCount(), 1u);
+  CHECK_EQ(stubEdges.size(), 2u * 4 * 3 * 8 * 2);
+
+  retryStrip.setRetryPolicy(NEO_RETRY_UNLIMITED);
+}
+#endif
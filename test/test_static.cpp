@@ -0,0 +1,86 @@
+// StaticNeoPixel::show() takes nothing from the heap, whatever the
+// features in use (user-030).  Palette mode still allocates its palette
+// when it is turned on, before the counting starts.
+#include "neo_test.h"
+
+static StaticNeoPixel<60, WS2812B> staticRgb(NEO_TEST_OUT);
+static StaticNeoPixel<60, SK6812RGBW> staticRgbw(NEO_TEST_OUT);
+#ifndef NEO_NO_CLOCKED
+static StaticNeoPixel<60, APA102> staticClocked(SPI);
+#endif
+
+// Shows three frames and returns the number of allocations they made
+static uint32_t showAllocs(Adafruit_NeoPixel &strip) {
+  uint32_t before = stubAllocs;
+  for (uint32_t i = 0; i < 3; i++) {
+    strip.setPixelColor(i, 0x204060);
+    strip.show();
+  }
+  return stubAllocs - before;
+}
+
+NEO_TEST(staticNoAllocDirect) {
+  staticRgb.begin();
+  CHECK_EQ(showAllocs(staticRgb), 0u);
+  staticRgb.setSkipUnchanged(true);
+  CHECK_EQ(showAllocs(staticRgb), 0u);
+  staticRgb.setSkipUnchanged(false);
+}
+
+NEO_TEST(staticNoAllocCustomTiming) {
+  staticRgb.begin();
+  NeoTiming t = staticRgb.getTiming();
+  t.resetUs = 2000; // Longer reset than any default
+  CHECK(staticRgb.setTiming(t));
+  CHECK_EQ(showAllocs(staticRgb), 0u);
+  staticRgb.resetTiming();
+}
+
+NEO_TEST(staticNoAllocPalette) {
+  staticRgb.begin();
+  CHECK(staticRgb.setPaletteMode(8));
+  staticRgb.setPaletteColor(1, 0x808080);
+  uint32_t before = stubAllocs;
+  for (uint32_t i = 0; i < 3; i++) {
+    staticRgb.setPixelIndex(i, 1);
+    staticRgb.show();
+  }
+  CHECK_EQ(stubAllocs - before, 0u);
+  CHECK(staticRgb.setPaletteMode(0));
+}
+
+NEO_TEST(staticNoAllocWhite) {
+  staticRgbw.begin();
+  CHECK(staticRgbw.setWhiteExtraction(true));
+  CHECK_EQ(showAllocs(staticRgbw), 0u);
+  staticRgbw.setWhiteExtraction(false);
+}
+
+#if HAL_PLATFORM_NRF52840
+static StaticNeoPixel<60, SK6812RGBW> staticDwt(2);
+
+NEO_TEST(staticNoAllocDwtFallback) {
+  stubPwmBusy = true; // No PWM device when the strip starts
+  stubReset();
+  Adafruit_NeoPixel &strip = staticDwt;
+  strip.begin();
+  CHECK(strip.setWhiteExtraction(true));
+  CHECK_EQ(showAllocs(strip), 0u);
+  CHECK(stubPwmOut.empty());
+  CHECK(!stubEdges.empty());
+  strip.setWhiteExtraction(false);
+}
+#endif
+
+#ifndef NEO_NO_CLOCKED
+NEO_TEST(staticNoAllocClocked) {
+  staticClocked.begin();
+  CHECK_EQ(showAllocs(staticClocked), 0u);
+  CHECK(staticClocked.setPaletteMode(4));
+  staticClocked.setPixelIndex(2, 1);
+  uint32_t before = stubAllocs;
+  staticClocked.show();
+  CHECK_EQ(stubAllocs - before, 0u);
+  CHECK(staticClocked.setPaletteMode(0));
+}
+#endif
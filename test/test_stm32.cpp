@@ -0,0 +1,42 @@
+// Cycle-counted STM32 kernel (user-042)
+#include "neo_test.h"
+
+#if (PLATFORM_ID == 6)
+static Adafruit_NeoPixel stm32Strip(3, 2, WS2812B);
+
+NEO_TEST(stm32KernelData) {
+  stm32Strip.begin();
+  stm32Strip.setPixelColor(0, 0x123456);
+  stm32Strip.setPixelColor(2, 0xFF00A5);
+  stm32Strip.show();
+
+  NeoTiming t = stm32Strip.getTiming();
+  uint32_t cyclesPerUs = SystemCoreClock / 1000000UL;
+  uint32_t threshold = (t.t0hNs + t.t1hNs) / 2 * cyclesPerUs / 1000UL;
+  std::vector<uint8_t> out = stubDecodeEdges(threshold);
+  const uint8_t expect[] = { 0x34, 0x12, 0x56, 0, 0, 0, 0x00, 0xFF, 0xA5 };
+  CHECK_EQ(out.size(), sizeof(expect));
+  for (size_t i = 0; i < out.size() && i < sizeof(expect); i++) CHECK_EQ(out[i], expect[i]);
+}
+
+// The time taken to notice the end of each wait must not add up: bit n
+// starts n periods after the first one, within a counter step.
+NEO_TEST(stm32KernelNoDrift) {
+  stubCyclesPerRead = 5;
+  stm32Strip.begin();
+  for (int i = 0; i < 3; i++) stm32Strip.setPixelColor(i, 0x5A5A5A);
+  stm32Strip.show();
+
+  std::vector<uint32_t> starts;
+  stubDecodeEdges(1, &starts);
+  NeoTiming t = stm32Strip.getTiming();
+  uint32_t cycPeriod = t.periodNs * (SystemCoreClock / 1000000UL) / 1000UL;
+  CHECK_EQ(starts.size(), 3u * 24);
+  uint32_t worst = 0;
+  for (size_t n = 1; n < starts.size(); n++) {
+    int32_t offset = (int32_t)((starts[n] - starts[0]) - n * cycPeriod);
+    if ((uint32_t)abs(offset) > worst) worst = abs(offset);
+  }
+  CHECK(worst <= stubCyclesPerRead);
+}
+#endif
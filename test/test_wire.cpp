@@ -0,0 +1,212 @@
+// Palette lookup and white extraction on the way to the wire (user-035,
+// user-039): the bit-banged and clocked outputs do it per pixel, and the
+// bit-banged ones copy the frame first only when that doesn't fit between
+// two bits.
+#include "neo_test.h"
+
+static void setPalette(Adafruit_NeoPixel &strip) {
+  CHECK(strip.setPaletteMode(4));
+  strip.setPaletteColor(1, 0x102030);
+  strip.setPaletteColor(2, 0xA0B0C0);
+  strip.setPixelIndex(0, 2);
+  strip.setPixelIndex(2, 1);
+}
+
+// Bytes sent for a WS2812B strip of 'setPalette' colors (GRB)
+static const uint8_t paletteWire[] = {
+  0xB0, 0xA0, 0xC0, 0, 0, 0, 0x20, 0x10, 0x30, 0, 0, 0 };
+
+static void checkBytes(const std::vector<uint8_t> &out, const uint8_t *expect, size_t len) {
+  CHECK_EQ(out.size(), len);
+  for (size_t i = 0; i < out.size() && i < len; i++) CHECK_EQ(out[i], expect[i]);
+}
+
+#if (PLATFORM_ID == 6) || HAL_PLATFORM_NRF52840
+// High time that tells 1 bits from 0 bits on the bit-banged outputs
+static uint32_t bitThreshold(const Adafruit_NeoPixel &strip) {
+  NeoTiming t = strip.getTiming();
+  return (t.t0hNs + t.t1hNs) / 2 * (SystemCoreClock / 1000000UL) / 1000UL;
+}
+
+// Heap copies show() makes of a frame with per-pixel lookups: one if the
+// lookup budget from neopixel.h doesn't fit in the low time of a 1 bit at
+// the current clock, as show() works it out
+static uint32_t lookupAllocs(const Adafruit_NeoPixel &strip, bool white) {
+  NeoTiming t = strip.getTiming();
+  uint32_t
+    cyclesPerUs = SystemCoreClock / 1000000UL,
+    low = t.periodNs * cyclesPerUs / 1000UL - t.t1hNs * cyclesPerUs / 1000UL,
+    budget = NEO_GAP_CYCLES + (white ? NEO_WHITE_CYCLES : NEO_PALETTE_CYCLES);
+  return budget > low ? 1 : 0;
+}
+
+NEO_TEST(wirePaletteBitBang) {
+  stubPwmBusy = true; // nRF52: use the DWT fallback
+  stubReset();
+  Adafruit_NeoPixel strip(4, 2, WS2812B);
+  strip.begin();
+  setPalette(strip);
+  stubReset();
+  strip.show();
+  CHECK_EQ(stubAllocs, lookupAllocs(strip, false));
+  checkBytes(stubDecodeEdges(bitThreshold(strip)), paletteWire, sizeof(paletteWire));
+}
+
+NEO_TEST(wireWhiteBitBang) {
+  stubPwmBusy = true;
+  stubReset();
+  Adafruit_NeoPixel strip(2, 2, SK6812RGBW);
+  strip.begin();
+  CHECK(strip.setWhiteExtraction(true));
+  strip.setPixelColor(0, 255, 255, 255);
+  strip.setPixelColor(1, 100, 40, 40, 5);
+  stubReset();
+  strip.show();
+  CHECK_EQ(stubAllocs, lookupAllocs(strip, true));
+  // R,G,B,W: white moves to W, the rest stays
+  const uint8_t expect[] = { 0, 0, 0, 255, 60, 0, 0, 45 };
+  checkBytes(stubDecodeEdges(bitThreshold(strip)), expect, sizeof(expect));
+  // The pixel buffer keeps the colors as set
+  CHECK_EQ(strip.getPixelColor(0), 0xFFFFFFu);
+}
+
+// Extraction with a tinted white LED against the plain divide formula,
+// through a moved strip so that the cached positions and factors go along
+NEO_TEST(wireWhiteTinted) {
+  stubPwmBusy = true;
+  stubReset();
+  Adafruit_NeoPixel first(64, 2, SK6812RGBW);
+  first.begin();
+  CHECK(first.setWhiteExtraction(true, 0xFFC896));
+  std::vector<uint8_t> in = testRandomize(first);
+  Adafruit_NeoPixel strip(std::move(first));
+  stubReset();
+  strip.show();
+  const uint32_t white[3] = { 0xFF, 0xC8, 0x96 };
+  std::vector<uint8_t> expect(in);
+  for (size_t i = 0; i < expect.size(); i += 4) {
+    uint32_t w = 255;
+    for (int c = 0; c < 3; c++) {
+      uint32_t x = (expect[i + c] * ((255U << 8) / white[c])) >> 8;
+      if (x < w) w = x;
+    }
+    for (int c = 0; c < 3; c++) expect[i + c] -= (w * white[c] + 127) / 255;
+    expect[i + 3] = (expect[i + 3] + w > 255) ? 255 : expect[i + 3] + w;
+  }
+  checkBytes(stubDecodeEdges(bitThreshold(strip)), expect.data(), expect.size());
+}
+
+// Lookups too slow for the low time of a bit are done before interrupts
+// go off, at the Photon clock and (STM32) the Core's 72MHz; the same bytes
+// go out either way.  At the Photon clock palette lookups always fit.
+NEO_TEST(wireLookupBudget) {
+  stubPwmBusy = true;
+  const uint32_t clock = SystemCoreClock;
+  const uint8_t types[] = { WS2812B, WS2811, TM1803, SK6812RGBW };
+#if HAL_PLATFORM_NRF52840
+  const uint32_t clocks[] = { clock };
+#else
+  const uint32_t clocks[] = { clock, 72000000 };
+#endif
+  for (uint32_t hz : clocks) {
+    SystemCoreClock = hz;
+    for (uint8_t type : types) {
+      for (int white = 0; white < 2; white++) {
+        const NeoPixelType &nt = neoPixelType(type);
+        stubReset();
+        Adafruit_NeoPixel strip(8, 2, type);
+        strip.begin();
+        std::vector<uint8_t> expect;
+        if (white) {
+          if (!strip.setWhiteExtraction(true)) continue;
+          strip.setPixelColor(0, 0x405060);
+          strip.setPixelColor(1, 0x102030);
+          for (uint32_t n = 0; n < 8; n++) {
+            uint32_t c = strip.getPixelColor(n), w = 0;
+            uint8_t rgb[3] = { (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c };
+            w = rgb[0] < rgb[1] ? rgb[0] : rgb[1];
+            if (rgb[2] < w) w = rgb[2];
+            for (uint8_t i = 0; i < nt.channels; i++) {
+              uint8_t ch = nt.order[i];
+              expect.push_back(ch == NEO_CH_W ? w : rgb[ch] - w);
+            }
+          }
+        } else {
+          CHECK(strip.setPaletteMode(4));
+          for (uint8_t i = 0; i < 16; i++) strip.setPaletteColor(i, i * 0x0A0B0C);
+          for (uint32_t n = 0; n < 8; n++) {
+            uint8_t index = testRandomByte() & 15;
+            strip.setPixelIndex(n, index);
+            uint32_t c = index * 0x0A0B0C;
+            for (uint8_t i = 0; i < nt.channels; i++) {
+              uint8_t ch = nt.order[i];
+              expect.push_back(ch == NEO_CH_W ? 0 : c >> (16 - 8 * ch));
+            }
+          }
+          if (hz == 120000000) CHECK_EQ(lookupAllocs(strip, false), 0u);
+        }
+        stubReset();
+        strip.show();
+        CHECK_EQ(stubAllocs, lookupAllocs(strip, white));
+        checkBytes(stubDecodeEdges(bitThreshold(strip)), expect.data(), expect.size());
+      }
+    }
+  }
+  SystemCoreClock = clock;
+}
+#endif
+
+#if HAL_PLATFORM_NRF52840
+NEO_TEST(wirePalettePwm) {
+  Adafruit_NeoPixel strip(4, 2, WS2812B);
+  strip.begin();
+  setPalette(strip);
+  strip.show();
+  checkBytes(stubDecodePwm(), paletteWire, sizeof(paletteWire));
+}
+#endif
+
+#if (PLATFORM_ID == 32)
+NEO_TEST(wirePaletteSpi) {
+  Adafruit_NeoPixel strip(4, SPI, WS2812B);
+  strip.begin();
+  setPalette(strip);
+  strip.show();
+  checkBytes(stubDecodeSpi(), paletteWire, sizeof(paletteWire));
+}
+#endif
+
+NEO_TEST(wirePaletteClocked) {
+  Adafruit_NeoPixel strip(200, SPI, APA102);
+  strip.begin();
+  setPalette(strip);
+  strip.setPixelIndex(199, 2);
+  stubReset();
+  strip.show();
+  CHECK_EQ(stubAllocs, 0u);
+  // Start frame, 4 bytes per pixel (brightness, B, G, R), end frame
+  CHECK_EQ(stubSpiOut.size(), 4u + 200 * 4 + 4 + (200 + 15) / 16);
+  const uint8_t first[] = { 0, 0, 0, 0, 0xFF, 0xC0, 0xB0, 0xA0, 0xFF, 0, 0, 0, 0xFF, 0x30, 0x20, 0x10 };
+  for (size_t i = 0; i < sizeof(first); i++) CHECK_EQ(stubSpiOut[i], first[i]);
+  const uint8_t last[] = { 0xFF, 0xC0, 0xB0, 0xA0 };
+  for (size_t i = 0; i < sizeof(last); i++) CHECK_EQ(stubSpiOut[4 + 199 * 4 + i], last[i]);
+}
+
+// A read-only attached buffer may be in flash, where DMA can't read: it
+// is sent through a RAM copy (user-040)
+static const uint8_t constFrame[3 * 4] = {
+  0xFF, 1, 2, 3, 0xFF, 4, 5, 6, 0xE1, 7, 8, 9 };
+
+NEO_TEST(wireConstClocked) {
+  Adafruit_NeoPixel strip(3, SPI, APA102);
+  strip.begin();
+  strip.attachBuffer(constFrame, sizeof(constFrame));
+  stubReset();
+  strip.show();
+  CHECK_EQ(stubAllocs, 0u);
+  for (const StubSpiTransfer &t : stubSpiTransfers) {
+    CHECK(t.tx + t.bytes <= constFrame || t.tx >= constFrame + sizeof(constFrame));
+  }
+  CHECK_EQ(stubSpiOut.size(), 4u + sizeof(constFrame) + 4 + 1);
+  for (size_t i = 0; i < sizeof(constFrame); i++) CHECK_EQ(stubSpiOut[4 + i], constFrame[i]);
+}